@@ -0,0 +1,245 @@
+/*
+	Title: Animation.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the Animation class
+*/
+
+#include "Animation.h"
+#include "SoftCanvas.h"
+#include <cstdio>
+#include <algorithm>
+
+
+Animation::Animation()
+{
+    width = height = 0;
+    numFrames = 0;
+    keyFrame = 0;
+}
+
+
+Animation::Animation(const string &FILE_PATH, const int NUM_FRAMES)
+{
+    width = height = 0;
+    numFrames = 0;
+    keyFrame = 0;
+
+    Frames frames(FILE_PATH, NUM_FRAMES);
+    build(&frames);
+}
+
+
+bool Animation::build(Frames* frames)
+{
+    numFrames = 0;
+    key.clear();
+    deltas.clear();
+    steps.clear();
+    colors.clear();
+    shown.clear();
+
+    const int N = frames->getNumFrames();
+    vector<unsigned char> first, prev, cur;
+    std::map<uint32_t, uint16_t> colorIndex;
+    for (int i = 0; i < N; i++)
+    {
+        ppm* img = frames->get(i);
+        if (img == NULL) {
+            cerr << "Error. Animation frame " << i << " couldn't be loaded" << endl;
+            return false;
+        }
+        if (i == 0) {
+            width = img->width;
+            height = img->height;
+            if (img->size > 0x10000) {
+                cerr << "Error. Animation frames are limited to 65536 pixels" << endl;
+                return false;
+            }
+        }
+        else if (img->width != width || img->height != height) {
+            cerr << "Error. Animation frame " << i << " is " << img->width << "x" << img->height << ", expected "
+                 << width << "x" << height << endl;
+            return false;
+        }
+
+        // Expand to interleaved RGB so frames compare the same whatever their storage
+        cur.resize(3*img->size);
+        for (unsigned int p = 0; p < img->size; p++)
+            img->pixel(p, cur[3*p], cur[3*p + 1], cur[3*p + 2]);
+
+        // Step i-1 -> i
+        if (i == 0)
+            first = cur;
+        else if (!addStep(prev, cur, colorIndex))
+            return false;
+        prev.swap(cur);
+    }
+    if (N < 1)
+        return false;
+
+    // The last frame loops back to the first
+    if (!addStep(prev, first, colorIndex))
+        return false;
+    steps.push_back(deltas.size());
+
+    numFrames = N;
+    key.swap(first);
+    keyFrame = 0;
+
+    const size_t FULL = (size_t) N*3*width*height;
+    fprintf(stderr, "Animation %d frames %ux%u, %zu bytes (%zu as full frames), %.1f pixels change per frame\n",
+            numFrames, width, height, bytes(), FULL, (double) deltas.size()/numFrames);
+    return true;
+}
+
+
+bool Animation::addStep(const vector<unsigned char> &from, const vector<unsigned char> &to,
+                        std::map<uint32_t, uint16_t> &colorIndex)
+{
+    steps.push_back(deltas.size());
+    for (size_t p = 0; 3*p < to.size(); p++)
+    {
+        const uint32_t OLD = from[3*p] << 16 | from[3*p + 1] << 8 | from[3*p + 2];
+        const uint32_t NEW = to[3*p] << 16 | to[3*p + 1] << 8 | to[3*p + 2];
+        if (OLD == NEW)
+            continue;
+
+        Delta d;
+        d.pos = p;
+        for (int k = 0; k < 2; k++)
+        {
+            const uint32_t RGB = k ? NEW : OLD;
+            std::map<uint32_t, uint16_t>::iterator it = colorIndex.find(RGB);
+            if (it == colorIndex.end())
+            {
+                if (colors.size() > 0xffff) {
+                    cerr << "Error. Animation has more than 65536 colors" << endl;
+                    return false;
+                }
+                it = colorIndex.insert(std::make_pair(RGB, (uint16_t) colors.size())).first;
+                colors.push_back(RGB);
+            }
+            (k ? d.newColor : d.oldColor) = it->second;
+        }
+        deltas.push_back(d);
+    }
+    return true;
+}
+
+
+size_t Animation::bytes() const
+{
+    return key.size() + deltas.size()*sizeof(Delta) + steps.size()*sizeof(unsigned int) +
+           colors.size()*sizeof(uint32_t);
+}
+
+
+int Animation::stepPath(const int FROM, const int TO, int &dir) const
+{
+    const int FWD = ((TO - FROM) % numFrames + numFrames) % numFrames;
+    if (FWD <= numFrames - FWD) {
+        dir = 1;
+        return FWD;
+    }
+    dir = -1;
+    return numFrames - FWD;
+}
+
+
+void Animation::applyStep(const int STEP, const bool FORWARD, Canvas* c, const int xPos, const int yPos) const
+{
+    const int C_WIDTH = c->width();
+    const int C_HEIGHT = c->height();
+    for (unsigned int i = steps[STEP]; i < steps[STEP + 1]; i++)
+    {
+        const Delta &d = deltas[i];
+        const int X = xPos + d.pos % width;
+        const int Y = yPos + d.pos / width;
+        if (X < 0 || Y < 0 || X >= C_WIDTH || Y >= C_HEIGHT)
+            continue;
+        const uint32_t RGB = colors[FORWARD ? d.newColor : d.oldColor];
+        c->SetPixel(X, Y, RGB >> 16, (RGB >> 8) & 0xff, RGB & 0xff);
+    }
+}
+
+
+void Animation::compose(const int INDEX)
+{
+    int dir;
+    const int COUNT = stepPath(keyFrame, INDEX, dir);
+    for (int k = 0; k < COUNT; k++)
+    {
+        const int STEP = (dir > 0) ? keyFrame : wrapIndex(keyFrame - 1);
+        for (unsigned int i = steps[STEP]; i < steps[STEP + 1]; i++)
+        {
+            const Delta &d = deltas[i];
+            const uint32_t RGB = colors[(dir > 0) ? d.newColor : d.oldColor];
+            unsigned char* p = &key[3*d.pos];
+            p[0] = RGB >> 16; p[1] = RGB >> 8; p[2] = RGB;
+        }
+        keyFrame = wrapIndex(keyFrame + dir);
+    }
+}
+
+
+void Animation::drawFull(const int INDEX, Canvas* c, const int xPos, const int yPos)
+{
+    if (numFrames == 0)
+        return;
+
+    const int FRAME = wrapIndex(INDEX);
+    compose(FRAME);
+
+    // Clip to the canvas
+    const int X_MIN = (xPos < 0) ? -xPos : 0;
+    const int Y_MIN = (yPos < 0) ? -yPos : 0;
+    const int X_MAX = std::min((int) width, c->width() - xPos);
+    const int Y_MAX = std::min((int) height, c->height() - yPos);
+    SoftCanvas* soft = dynamic_cast<SoftCanvas*>(c);
+    for (int y = Y_MIN; y < Y_MAX; y++)
+    {
+        const unsigned char* p = &key[3*(y*width + X_MIN)];
+        if (soft != NULL) // Rows of the keyframe are already packed RGB
+        {
+            if (X_MIN < X_MAX)
+                soft->putRGB(xPos + X_MIN, yPos + y, p, X_MAX - X_MIN);
+            continue;
+        }
+        for (int x = X_MIN; x < X_MAX; x++, p += 3)
+            c->SetPixel(xPos + x, yPos + y, p[0], p[1], p[2]);
+    }
+
+    Shown s = {FRAME, xPos, yPos};
+    shown[c] = s;
+}
+
+
+void Animation::draw(const int INDEX, Canvas* c, const int xPos, const int yPos)
+{
+    if (numFrames == 0)
+        return;
+
+    std::map<const Canvas*, Shown>::iterator it = shown.find(c);
+    if (it == shown.end() || it->second.xPos != xPos || it->second.yPos != yPos)
+    {
+        drawFull(INDEX, c, xPos, yPos);
+        return;
+    }
+
+    // Walk the canvas from the frame it shows to the one requested
+    int &frame = it->second.frame;
+    int dir;
+    const int COUNT = stepPath(frame, wrapIndex(INDEX), dir);
+    for (int k = 0; k < COUNT; k++)
+    {
+        if (dir > 0) {
+            applyStep(frame, true, c, xPos, yPos);
+            frame = wrapIndex(frame + 1);
+        }
+        else {
+            frame = wrapIndex(frame - 1);
+            applyStep(frame, false, c, xPos, yPos);
+        }
+    }
+}
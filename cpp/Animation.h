@@ -0,0 +1,126 @@
+/*
+	Title: Animation.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   Animation class - Frame sequence stored as one keyframe plus the pixels that change between frames
+
+	Consecutive animation frames usually differ in a handful of pixels. Instead of holding and redrawing every
+	frame, the animation keeps one keyframe and, for each step, the pixels that change (with their old and new colors,
+	so playback can run forwards or backwards). Drawing only writes those pixels onto whatever the canvas already
+	shows. The animation's rectangle is opaque: black pixels are written too, so nothing else should draw there.
+*/
+
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include "ppm.h"
+#include <map>
+
+
+//==============// ANIMATION CLASS
+class Animation
+{
+
+private:
+    // Delta: One pixel that changes between two consecutive frames, colors are indices into colors
+    struct Delta
+    {
+        uint16_t pos;       // y*width + x
+        uint16_t oldColor;
+        uint16_t newColor;
+    };
+
+    // Shown: What an individual canvas holds, so each buffer of a double-buffered matrix is stepped on its own
+    struct Shown
+    {
+        int frame;
+        int xPos;
+        int yPos;
+    };
+
+    unsigned int width;
+    unsigned int height;
+    int numFrames;
+
+    // colors: Every color the deltas use, as 0xRRGGBB
+    vector<uint32_t> colors;
+
+    /*
+    deltas, steps: The changes from frame i to frame i+1 (wrapping to frame 0 after the last) are
+        deltas[steps[i]] ... deltas[steps[i+1]-1]
+    */
+    vector<Delta> deltas;
+    vector<unsigned int> steps;
+
+    // key, keyFrame: The one full frame held, as interleaved RGB. Starts as frame 0 and is stepped through the
+    //                deltas like a canvas when a full redraw needs another frame.
+    vector<unsigned char> key;
+    int keyFrame;
+
+    std::map<const Canvas*, Shown> shown;
+
+    // wrapIndex(): INDEX brought into 0 ... numFrames-1
+    int wrapIndex(const int INDEX) const { return (INDEX % numFrames + numFrames) % numFrames; }
+
+    // addStep(): Appends the step between two interleaved RGB frames (the pixels that differ). Returns false if the
+    //            animation needs more than 65536 colors.
+    bool addStep(const vector<unsigned char> &from, const vector<unsigned char> &to,
+                 std::map<uint32_t, uint16_t> &colorIndex);
+
+    // stepPath(): Shortest way from frame FROM to frame TO. Returns the number of steps, dir is set to +1 or -1.
+    int stepPath(const int FROM, const int TO, int &dir) const;
+
+    // applyStep(): Writes the pixels of step STEP onto the canvas (new colors going forward, old colors going back)
+    void applyStep(const int STEP, const bool FORWARD, Canvas* c, const int xPos, const int yPos) const;
+
+    // compose(): Steps the keyframe to INDEX
+    void compose(const int INDEX);
+
+
+public:
+    // Animation(): Empty animation, call build()
+    Animation();
+
+    // Animation(FILE_PATH, NUM_FRAMES): Calls build() on the frames at FILE_PATH (see Frames::setSource())
+    Animation(const string &FILE_PATH, const int NUM_FRAMES);
+
+    /*
+    build(): Encodes every frame of FRAMES. All frames must be the same size. The frames are only read here,
+        they can be unloaded afterwards. Frames are limited to 65536 pixels.
+        Returns false and writes to cerr upon error.
+    */
+    bool build(Frames* frames);
+
+    // Getters
+    int getNumFrames() const { return numFrames; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // bytes(): Memory held by the keyframe, the deltas and their colors
+    size_t bytes() const;
+
+    // deltaCount(): Total changed pixels over one loop of the animation
+    size_t deltaCount() const { return deltas.size(); }
+
+    /*
+    draw(): Shows frame INDEX (wrapped into range) on the canvas with its TOP-LEFT at xPos, yPos.
+        If this canvas last showed another frame of the animation at the same spot, only the pixels that differ
+        are written. Otherwise (first draw, moved, or invalidated) the whole rectangle is drawn.
+    */
+    void draw(const int INDEX, Canvas* c, const int xPos, const int yPos);
+
+    // drawFull(): Draws the whole rectangle of frame INDEX, regardless of what the canvas shows
+    void drawFull(const int INDEX, Canvas* c, const int xPos, const int yPos);
+
+    // shows(): True if the canvas holds a frame of the animation, i.e. draw() will only write the changed pixels
+    bool shows(const Canvas* c) const { return shown.count(c) != 0; }
+
+    // invalidate(): Forget what the canvas shows, e.g. after Clear() or drawing something else over the animation
+    void invalidate(const Canvas* c) { shown.erase(c); }
+
+    // invalidate(): Forget every canvas, e.g. on a screen change
+    void invalidate() { shown.clear(); }
+};
+
+#endif
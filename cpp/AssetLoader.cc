@@ -0,0 +1,145 @@
+/*
+	Title: AssetLoader.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the AssetLoader class
+*/
+
+#include "AssetLoader.h"
+#include <unistd.h>
+#include <ctime>
+#include <cstdio>
+#include <algorithm>
+
+
+AssetLoader::AssetLoader(const int THREADS)
+{
+    numThreads = THREADS;
+    if (numThreads <= 0)
+        numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads <= 0)
+        numThreads = 1;
+
+    pthread_mutex_init(&jobLock, NULL);
+    nextJob = 0;
+    startUsec = 0;
+}
+
+
+AssetLoader::~AssetLoader()
+{
+    pthread_mutex_destroy(&jobLock);
+}
+
+
+double AssetLoader::nowUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec*1e6 + ts.tv_nsec/1e3;
+}
+
+
+void AssetLoader::add(const string &NAME, Frames* frames, const int FIRST, const int COUNT)
+{
+    AssetSet s;
+    s.name = NAME;
+    s.frames = frames;
+    s.first = FIRST;
+    s.count = (COUNT < 0) ? frames->getNumFrames() : COUNT;
+    s.loaded = 0;
+    s.failed = 0;
+    s.decodeUsec = 0;
+    s.doneUsec = 0;
+    sets.push_back(s);
+}
+
+
+void AssetLoader::worker()
+{
+    while (true)
+    {
+        pthread_mutex_lock(&jobLock);
+        size_t j = nextJob++;
+        pthread_mutex_unlock(&jobLock);
+        if (j >= jobs.size())
+            break;
+
+        // Each job owns its own output slot, only the counter is shared
+        Job &job = jobs[j];
+        double start = nowUsec();
+        job.img = sets[job.set].frames->decode(job.index);
+        job.doneUsec = nowUsec();
+        job.usec = job.doneUsec - start;
+        job.doneUsec -= startUsec;
+    }
+}
+
+
+bool AssetLoader::run()
+{
+    startUsec = nowUsec();
+
+    // Build the job list on this thread, atlases get mapped here. Frames asked for are held until they've all been
+    // handed over, so adopting the later ones doesn't evict the earlier ones.
+    FrameCache::shared().hold();
+    jobs.clear();
+    for (size_t s = 0; s < sets.size(); s++)
+    {
+        Frames* f = sets[s].frames;
+        f->openSource();
+        const int N = f->getNumFrames();
+        sets[s].loaded = std::min(sets[s].count, N);
+        for (int n = 0; n < sets[s].loaded; n++)
+        {
+            Job job;
+            job.set = s;
+            job.index = ((sets[s].first + n) % N + N) % N;
+            job.img = NULL;
+            job.usec = job.doneUsec = 0;
+            if (!f->isLoaded(job.index))
+                jobs.push_back(job);
+            else
+                f->get(job.index); // Already in memory, marks it held
+        }
+    }
+    nextJob = 0;
+
+    // Decode, the calling thread works too
+    const int EXTRA = std::min((int) jobs.size(), numThreads) - 1;
+    vector<pthread_t> threads;
+    for (int t = 0; t < EXTRA; t++)
+    {
+        pthread_t th;
+        if (pthread_create(&th, NULL, &workerWrapper, this) == 0)
+            threads.push_back(th);
+    }
+    worker();
+    for (size_t t = 0; t < threads.size(); t++)
+        pthread_join(threads[t], NULL);
+
+    // Hand frames over and tally per set
+    bool allGood = true;
+    for (size_t j = 0; j < jobs.size(); j++)
+    {
+        AssetSet &s = sets[jobs[j].set];
+        if (s.frames->adopt(jobs[j].index, jobs[j].img) == NULL)
+        {
+            s.failed++;
+            allGood = false;
+        }
+        s.decodeUsec += jobs[j].usec;
+        s.doneUsec = std::max(s.doneUsec, jobs[j].doneUsec);
+    }
+    FrameCache::shared().release();
+
+    const double TOTAL = nowUsec() - startUsec;
+    for (size_t s = 0; s < sets.size(); s++)
+    {
+        fprintf(stderr, "Assets %-10s %3d frames, %d failed, ready at %.2f ms (%.2f ms decoding)\n",
+                sets[s].name.c_str(), sets[s].loaded, sets[s].failed, sets[s].doneUsec/1e3, sets[s].decodeUsec/1e3);
+    }
+    fprintf(stderr, "Assets loaded in %.2f ms on %zu threads\n", TOTAL/1e3, threads.size() + 1);
+
+    return allGood;
+}
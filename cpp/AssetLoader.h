@@ -0,0 +1,79 @@
+/*
+	Title: AssetLoader.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   AssetLoader class - Startup phase that decodes Frames sets across a pool of worker threads
+*/
+
+
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "ppm.h"
+#include <pthread.h>
+
+
+//==============// ASSET LOADER CLASS
+class AssetLoader
+{
+
+private:
+    // AssetSet: One Frames object queued by add(), with its timing
+    struct AssetSet
+    {
+        string name;
+        Frames* frames;
+        int first;
+        int count;
+        int loaded;         // Frames run() covered, count capped at the frames the set has
+        int failed;
+        double decodeUsec;  // Sum of per-frame decode times (CPU time spent on the set)
+        double doneUsec;    // When the last frame of the set finished, relative to the start of run()
+    };
+
+    // Job: One frame to decode. img is filled in by a worker.
+    struct Job
+    {
+        int set;
+        int index;
+        ppm* img;
+        double usec;
+        double doneUsec;
+    };
+
+    vector<AssetSet> sets;
+    vector<Job> jobs;
+    int numThreads;
+
+    // Shared between workers
+    pthread_mutex_t jobLock;
+    size_t nextJob;
+    double startUsec;
+
+    // worker(): Pulls jobs until none are left
+    void worker();
+    static void* workerWrapper(void* loader) { ((AssetLoader*) loader)->worker(); return NULL; }
+
+
+public:
+    // AssetLoader(): THREADS workers, 0 = one per online core
+    AssetLoader(const int THREADS = 0);
+
+    ~AssetLoader();
+
+    // add(): Queues COUNT frames of FRAMES starting at FIRST (COUNT = -1 for every frame). NAME is used in the report.
+    void add(const string &NAME, Frames* frames, const int FIRST = 0, const int COUNT = -1);
+
+    /*
+    run(): Decodes every queued frame across the workers, then hands the frames to their Frames objects (on the
+        calling thread, so the frame cache needs no locking). Frames already in memory are skipped. None of the queued
+        frames are evicted before run() returns, even when they add up to more than the cache budget.
+        Prints load times per set to cerr. Returns false if any frame couldn't be loaded.
+    */
+    bool run();
+
+    // nowUsec(): Monotonic timestamp in microseconds
+    static double nowUsec();
+};
+
+#endif
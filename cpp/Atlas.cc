@@ -0,0 +1,221 @@
+/*
+	Title: Atlas.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the Atlas class
+*/
+
+#include "Atlas.h"
+#include "ppm.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+
+
+const EmbeddedAsset* findEmbeddedAsset(const string &FILE_PATH)
+{
+    if (embeddedAssets == NULL) // No bundle linked in
+        return NULL;
+
+    int count = 0;
+    const EmbeddedAsset* assets = embeddedAssets(&count);
+    for (int i = 0; i < count; i++)
+    {
+        if (FILE_PATH == assets[i].path)
+            return &assets[i];
+    }
+    return NULL;
+}
+
+
+Atlas::Atlas()
+{
+    base = NULL;
+    length = 0;
+    mapped = false;
+}
+
+
+Atlas::~Atlas()
+{
+    this->close();
+}
+
+
+bool Atlas::open(const string &fname)
+{
+    this->close();
+
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error. Unable to open " << fname << endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(AtlasHeader)) {
+        cerr << "Error. " << fname << " is too small to be an atlas" << endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // Mapping stays valid after the fd is closed
+    if (map == MAP_FAILED) {
+        cerr << "Error. Unable to map " << fname << endl;
+        return false;
+    }
+    base = (const unsigned char*) map;
+    length = st.st_size;
+    mapped = true;
+
+    if (!validate(fname))
+        return false;
+
+    // Frames are small and all get drawn eventually, start reading them in now
+    madvise(map, length, MADV_WILLNEED);
+    return true;
+}
+
+
+bool Atlas::openMemory(const unsigned char* data, const size_t LENGTH, const string &name)
+{
+    this->close();
+    if (data == NULL || LENGTH < sizeof(AtlasHeader)) {
+        cerr << "Error. " << name << " is too small to be an atlas" << endl;
+        return false;
+    }
+
+    base = data;
+    length = LENGTH;
+    mapped = false;
+    return validate(name);
+}
+
+
+bool Atlas::validate(const string &fname)
+{
+    const AtlasHeader* hdr = (const AtlasHeader*) base;
+    if (memcmp(hdr->magic, ATLAS_MAGIC, 4) != 0 || hdr->version != ATLAS_VERSION) {
+        cerr << "Error. " << fname << " is not a version " << ATLAS_VERSION << " atlas" << endl;
+        this->close();
+        return false;
+    }
+    // Divided rather than multiplied, a corrupt count can't wrap a 32-bit size_t past the check
+    if (hdr->count > (length - sizeof(AtlasHeader))/sizeof(AtlasEntry)) {
+        cerr << "Error. Truncated atlas index in " << fname << endl;
+        this->close();
+        return false;
+    }
+
+    // Validate every frame up front so getFrame() can't hand out pointers past the mapping
+    const AtlasEntry* index = (const AtlasEntry*) (base + sizeof(AtlasHeader));
+    for (uint32_t i = 0; i < hdr->count; i++)
+    {
+        size_t planeSize = (size_t) index[i].width*index[i].height;
+        if (planeSize == 0 || index[i].offset > length || length - index[i].offset < 3*planeSize) {
+            cerr << "Error. Bad atlas entry " << i << " in " << fname << endl;
+            this->close();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void Atlas::close()
+{
+    if (base != NULL && mapped)
+        munmap((void*) base, length);
+    base = NULL;
+    length = 0;
+    mapped = false;
+}
+
+
+int Atlas::getNumFrames() const
+{
+    if (base == NULL)
+        return 0;
+    return ((const AtlasHeader*) base)->count;
+}
+
+
+bool Atlas::getFrame(const int INDEX, ppm &img) const
+{
+    if (INDEX < 0 || INDEX >= getNumFrames())
+        return false;
+
+    const AtlasEntry &e = ((const AtlasEntry*) (base + sizeof(AtlasHeader)))[INDEX];
+    const unsigned char* r = base + e.offset;
+    const size_t PLANE = (size_t) e.width*e.height;
+
+    img.wrap(e.width, e.height, r, r + PLANE, r + 2*PLANE);
+    return true;
+}
+
+
+bool Atlas::pack(const vector<ppm*> &frames, vector<unsigned char> &out)
+{
+    AtlasHeader hdr;
+    memcpy(hdr.magic, ATLAS_MAGIC, 4);
+    hdr.version = ATLAS_VERSION;
+    hdr.count = frames.size();
+    hdr.reserved = 0;
+
+    // Lay out the index, frames start aligned after it
+    vector<AtlasEntry> index(frames.size());
+    size_t offset = sizeof(AtlasHeader) + frames.size()*sizeof(AtlasEntry);
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        if (frames[i]->width == 0 || frames[i]->width > 0xffff || frames[i]->height > 0xffff ||
+            frames[i]->hasAlpha()) { // Atlases hold R,G,B planes only
+            cerr << "Error. Frame " << i << " can't be stored in an atlas" << endl;
+            return false;
+        }
+        offset = (offset + ATLAS_ALIGN - 1) & ~(size_t) (ATLAS_ALIGN - 1);
+        index[i].width = frames[i]->width;
+        index[i].height = frames[i]->height;
+        index[i].offset = offset;
+        offset += 3*frames[i]->size;
+    }
+
+    out.assign(offset, 0); // Padding stays zero
+    memcpy(&out[0], &hdr, sizeof(hdr));
+    if (!index.empty())
+        memcpy(&out[sizeof(hdr)], &index[0], index.size()*sizeof(AtlasEntry));
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        // Expand to planes (frames read from disk are usually palette-indexed)
+        const unsigned int SIZE = frames[i]->size;
+        unsigned char* planes = &out[index[i].offset];
+        for (unsigned int p = 0; p < SIZE; p++)
+            frames[i]->pixel(p, planes[p], planes[SIZE + p], planes[2*SIZE + p]);
+    }
+    return true;
+}
+
+
+bool Atlas::write(const string &fname, const vector<ppm*> &frames)
+{
+    vector<unsigned char> data;
+    if (!pack(frames, data))
+        return false;
+
+    std::ofstream out(fname.c_str(), std::ios::out | std::ios::binary);
+    if (!out.is_open()) {
+        cerr << "Error. Unable to open " << fname << endl;
+        return false;
+    }
+
+    out.write((const char*) &data[0], data.size());
+    if (!out.good()) {
+        cerr << "Error. Failed writing " << fname << endl;
+        return false;
+    }
+    return true;
+}
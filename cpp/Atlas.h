@@ -0,0 +1,116 @@
+/*
+	Title: Atlas.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   Atlas class - Read-only memory mapping of a packed sprite atlas (many frames in one file)
+
+	File layout (little-endian, all offsets from the start of the file):
+		AtlasHeader                     magic "PPMA", version, frame count
+		AtlasEntry[count]               width, height, offset of each frame's pixels
+		pixel data                      per frame: R plane, G plane, B plane (width*height bytes each),
+		                                each frame starts on an ATLAS_ALIGN boundary
+	Atlases are built offline from loose PPM frames with ppm-pack, either as files next to the frame directories or
+	compiled into weather-disp as an embedded bundle (make embed).
+*/
+
+
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+using std::string; using std::vector;
+
+class ppm;
+
+const char ATLAS_MAGIC[4] = {'P','P','M','A'};
+const uint32_t ATLAS_VERSION = 1;
+const uint32_t ATLAS_ALIGN = 16;
+
+struct AtlasHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t count;     // Number of frames
+    uint32_t reserved;
+};
+
+struct AtlasEntry
+{
+    uint16_t width;
+    uint16_t height;
+    uint32_t offset;    // Start of the R plane, G and B planes follow directly
+};
+
+
+// EmbeddedAsset: An atlas compiled into the binary, keyed by the Frames filepath it replaces
+struct EmbeddedAsset
+{
+    const char* path;
+    const unsigned char* data;
+    size_t length;
+};
+
+/*
+    embeddedAssets(): Defined by the embedded-assets.cc file ppm-pack generates for the embed target. Weak, so the
+        function is NULL in builds without the bundle. Sets count to the number of entries.
+*/
+const EmbeddedAsset* embeddedAssets(int* count) __attribute__((weak));
+
+// findEmbeddedAsset(): The embedded atlas for FILE_PATH, NULL if there is none (or no bundle linked in)
+const EmbeddedAsset* findEmbeddedAsset(const string &FILE_PATH);
+
+
+//==============// ATLAS CLASS
+class Atlas
+{
+
+private:
+    // base, length: The mapping (or static data), NULL/0 when nothing is open
+    const unsigned char* base;
+    size_t length;
+    // mapped: True if base came from mmap() and must be unmapped
+    bool mapped;
+
+    // validate(): Checks the header and index of the open data, closes it on failure. name is used in messages.
+    bool validate(const string &name);
+
+    // Not copyable, the mapping has a single owner
+    Atlas(const Atlas&);
+    Atlas& operator=(const Atlas&);
+
+
+public:
+    // Atlas(): Empty atlas, call open()
+    Atlas();
+
+    // ~Atlas(): Calls close()
+    ~Atlas();
+
+    // open(): Maps fname read-only and validates the header and index. Returns false and writes to cerr upon error.
+    bool open(const string &fname);
+
+    // openMemory(): Uses an atlas already in memory (e.g. an EmbeddedAsset) in place, without copying. The data must
+    //               outlive the atlas. Returns false and writes to cerr if it isn't a valid atlas.
+    bool openMemory(const unsigned char* data, const size_t LENGTH, const string &name);
+
+    // close(): Unmaps the file. Any ppm wrapping frames of this atlas must not be drawn afterwards.
+    void close();
+
+    // getNumFrames(): Number of frames in the open atlas (0 when closed)
+    int getNumFrames() const;
+
+    // getFrame(): Points img at the pixels of frame INDEX inside the mapping (no copy). Returns false if out of range.
+    bool getFrame(const int INDEX, ppm &img) const;
+
+    // pack(): Packs the given frames into an atlas image in out. Returns false and writes to cerr upon error.
+    static bool pack(const vector<ppm*> &frames, vector<unsigned char> &out);
+
+    // write(): Packs the given frames into an atlas file. Returns false and writes to cerr upon error.
+    static bool write(const string &fname, const vector<ppm*> &frames);
+};
+
+#endif
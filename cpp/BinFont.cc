@@ -0,0 +1,439 @@
+/*
+	Title: BinFont.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the BinFont class
+*/
+
+#include "BinFont.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+
+using std::cerr; using std::endl;
+
+
+// GlyphCapture: Canvas that records the glyph box the library draws. Foreground pixels are drawn in white,
+//               background in black, so every pixel of the box shows up.
+class GlyphCapture : public Canvas
+{
+public:
+	vector<int> xs, ys;
+	vector<bool> fg;
+	int xMin, yMin, xMax, yMax;
+	GlyphCapture() : xMin(INT_MAX), yMin(INT_MAX), xMax(INT_MIN), yMax(INT_MIN) {}
+	virtual int width() const { return INT_MAX/2; }
+	virtual int height() const { return INT_MAX/2; }
+	virtual void SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue)
+	{
+		xs.push_back(x);
+		ys.push_back(y);
+		fg.push_back(red != 0);
+		xMin = std::min(xMin, x); xMax = std::max(xMax, x);
+		yMin = std::min(yMin, y); yMax = std::max(yMax, y);
+	}
+	virtual void Clear() {}
+	virtual void Fill(uint8_t red, uint8_t green, uint8_t blue) {}
+};
+
+
+// Substitution: ASCII look-alike for a code point a font may lack (verses and summaries come with typography)
+struct Substitution
+{
+    uint32_t codepoint;
+    const char* ascii;
+};
+
+static const Substitution SUBSTITUTIONS[] = {
+    {0x00A0, " "},      // No-break space
+    {0x2010, "-"}, {0x2011, "-"}, {0x2012, "-"}, {0x2013, "-"}, {0x2014, "-"}, {0x2015, "-"}, {0x2212, "-"},
+    {0x2018, "'"}, {0x2019, "'"}, {0x201A, ","}, {0x201B, "'"}, {0x2032, "'"},
+    {0x201C, "\""}, {0x201D, "\""}, {0x201E, "\""}, {0x201F, "\""}, {0x2033, "\""},
+    {0x2022, "*"},      // Bullet
+    {0x2026, "..."},    // Ellipsis
+};
+static const int NUM_SUBSTITUTIONS = sizeof(SUBSTITUTIONS)/sizeof(SUBSTITUTIONS[0]);
+
+// MAX_BDF_CODEPOINT: Code points probed when converting a BDF font in memory (the Basic Multilingual Plane)
+static const uint32_t MAX_BDF_CODEPOINT = 0xFFFF;
+
+
+BinFont::BinFont()
+{
+    base = NULL;
+    length = 0;
+    mapped = false;
+    replacement = -1;
+    memset(low, -1, sizeof(low));
+}
+
+
+BinFont::~BinFont()
+{
+    this->close();
+}
+
+
+string BinFont::binPath(const string &BDF_PATH)
+{
+    const size_t DOT = BDF_PATH.rfind('.');
+    const size_t SLASH = BDF_PATH.rfind('/');
+    if (DOT == string::npos || (SLASH != string::npos && DOT < SLASH))
+        return BDF_PATH + ".bfnt";
+    return BDF_PATH.substr(0, DOT) + ".bfnt";
+}
+
+
+bool BinFont::LoadFont(const char* path)
+{
+    this->close();
+
+    struct stat st;
+    const string BIN = binPath(path);
+    if (stat(BIN.c_str(), &st) == 0 && map(BIN))
+        return true;
+
+    // No precompiled font, parse the BDF and convert every glyph it has
+    Font bdf;
+    if (!bdf.LoadFont(path))
+        return false;
+    vector<uint32_t> cps;
+    for (uint32_t cp = 0; cp <= MAX_BDF_CODEPOINT; cp++)
+    {
+        if (bdf.CharacterWidth(cp) >= 0)
+            cps.push_back(cp);
+    }
+    if (!pack(bdf, cps, built))
+        return false;
+    base = &built[0];
+    length = built.size();
+    if (!index(path))
+    {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+
+bool BinFont::map(const string &fname)
+{
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error. Unable to open " << fname << endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(BinFontHeader)) {
+        cerr << "Error. " << fname << " is too small to be a font" << endl;
+        ::close(fd);
+        return false;
+    }
+
+    void* m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // Mapping stays valid after the fd is closed
+    if (m == MAP_FAILED) {
+        cerr << "Error. Unable to map " << fname << endl;
+        return false;
+    }
+    base = (const unsigned char*) m;
+    length = st.st_size;
+    mapped = true;
+
+    if (!index(fname))
+    {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+
+bool BinFont::index(const string &NAME)
+{
+    // Validate header and geometry so glyph reads stay inside the records
+    const BinFontHeader* hdr = header();
+    if (memcmp(hdr->magic, BIN_FONT_MAGIC, 4) != 0 || hdr->version != BIN_FONT_VERSION) {
+        cerr << "Error. " << NAME << " is not a version " << BIN_FONT_VERSION << " font" << endl;
+        return false;
+    }
+    if (hdr->recordSize < sizeof(BinGlyph) + (size_t) hdr->maxRows*hdr->rowBytes || hdr->recordSize % 4 != 0 ||
+        sizeof(BinFontHeader) + (size_t) hdr->count*hdr->recordSize > length) {
+        cerr << "Error. Bad glyph records in " << NAME << endl;
+        return false;
+    }
+    for (unsigned int i = 0; i < hdr->count; i++)
+    {
+        const BinGlyph* g = record(i);
+        if (g->rows > hdr->maxRows || g->advance > 8*hdr->rowBytes ||
+            (i > 0 && g->codepoint <= record(i - 1)->codepoint)) {
+            cerr << "Error. Bad glyph " << i << " in " << NAME << endl;
+            return false;
+        }
+        if (g->codepoint < 256)
+            low[g->codepoint] = i;
+    }
+    replacement = glyphIndex(0xFFFD);
+    return true;
+}
+
+
+void BinFont::close()
+{
+    if (mapped)
+        munmap((void*) base, length);
+    base = NULL;
+    length = 0;
+    mapped = false;
+    vector<unsigned char>().swap(built);
+    replacement = -1;
+    memset(low, -1, sizeof(low));
+}
+
+
+int BinFont::glyphIndex(const uint32_t CP) const
+{
+    if (CP < 256)
+        return low[CP];
+    if (base == NULL)
+        return -1;
+
+    // Binary search the sorted records
+    int lo = 0, hi = (int) header()->count - 1;
+    while (lo <= hi)
+    {
+        const int MID = (lo + hi)/2;
+        const uint32_t AT = record(MID)->codepoint;
+        if (AT == CP)
+            return MID;
+        if (AT < CP)
+            lo = MID + 1;
+        else
+            hi = MID - 1;
+    }
+    return -1;
+}
+
+
+void BinFont::decode(const uint32_t CP, Glyphs &out) const
+{
+    const int GLYPH = glyphIndex(CP);
+    if (GLYPH >= 0)
+    {
+        out.push_back(GLYPH);
+        return;
+    }
+
+    for (int i = 0; i < NUM_SUBSTITUTIONS; i++)
+    {
+        if (SUBSTITUTIONS[i].codepoint != CP)
+            continue;
+        for (const char* c = SUBSTITUTIONS[i].ascii; *c; c++)
+        {
+            const int SUB = low[(unsigned char) *c];
+            if (SUB >= 0)
+                out.push_back(SUB);
+            else if (replacement >= 0)
+                out.push_back(replacement);
+        }
+        return;
+    }
+
+    if (replacement >= 0)
+        out.push_back(replacement);
+}
+
+
+void BinFont::decode(const char* it, const char* END, Glyphs &out) const
+{
+    while (it < END)
+        decode(nextCodepoint(it, END), out);
+}
+
+
+int BinFont::height() const
+{
+    return (base != NULL) ? header()->height : -1;
+}
+
+
+int BinFont::baseline() const
+{
+    return (base != NULL) ? header()->baseline : 0;
+}
+
+
+int BinFont::CharacterWidth(const uint32_t CP) const
+{
+    const int GLYPH = glyphIndex(CP);
+    return (GLYPH >= 0) ? record(GLYPH)->advance : -1;
+}
+
+
+int BinFont::drawGlyph(Canvas* c, int x, int y, const Color &color, const Color* backColor, const uint16_t GLYPH) const
+{
+    const BinGlyph* g = record(GLYPH);
+    const unsigned int ROW_BYTES = header()->rowBytes;
+    const unsigned char* row = (const unsigned char*) (g + 1);
+    for (int r = 0; r < g->rows; r++, row += ROW_BYTES)
+    {
+        const int Y = y + g->top + r;
+        for (int px = 0; px < g->advance; px++)
+        {
+            if (row[px >> 3] & (0x80 >> (px & 7)))
+                c->SetPixel(x + px, Y, color.r, color.g, color.b);
+            else if (backColor != NULL)
+                c->SetPixel(x + px, Y, backColor->r, backColor->g, backColor->b);
+        }
+    }
+    return g->advance;
+}
+
+
+int BinFont::DrawGlyph(Canvas* c, int x, int y, const Color &color, const Color* backColor, const uint32_t CP) const
+{
+    int glyph = glyphIndex(CP);
+    if (glyph < 0)
+        glyph = replacement;
+    if (glyph < 0)
+        return 0;
+    return drawGlyph(c, x, y, color, backColor, glyph);
+}
+
+
+bool BinFont::pack(const Font &FONT, const vector<uint32_t> &cps, vector<unsigned char> &out)
+{
+    // Capture every glyph the font has, to size the records
+    const Color FG(255, 255, 255), BG(0, 0, 0);
+    vector<uint32_t> kept;
+    vector<GlyphCapture> caps;
+    vector<int> advances;
+    int maxAdvance = 0, maxRows = 0;
+    for (size_t i = 0; i < cps.size(); i++)
+    {
+        const int ADVANCE = FONT.CharacterWidth(cps[i]);
+        if (ADVANCE < 0)
+            continue;
+        if (ADVANCE > 255) {
+            cerr << "Error. Glyph " << cps[i] << " is too wide" << endl;
+            return false;
+        }
+        caps.push_back(GlyphCapture());
+        GlyphCapture &cap = caps.back();
+        FONT.DrawGlyph(&cap, 0, 0, FG, &BG, cps[i]);
+        if (!cap.ys.empty() && (cap.yMin < -128 || cap.yMax > 127 || cap.yMax - cap.yMin + 1 > 255)) {
+            cerr << "Error. Glyph " << cps[i] << " is too tall" << endl;
+            return false;
+        }
+        kept.push_back(cps[i]);
+        advances.push_back(ADVANCE);
+        maxAdvance = std::max(maxAdvance, ADVANCE);
+        if (!cap.ys.empty())
+            maxRows = std::max(maxRows, cap.yMax - cap.yMin + 1);
+    }
+    if (kept.empty() || kept.size() > 0xffff) {
+        cerr << "Error. No glyphs to write" << endl;
+        return false;
+    }
+
+    BinFontHeader hdr;
+    memcpy(hdr.magic, BIN_FONT_MAGIC, 4);
+    hdr.version = BIN_FONT_VERSION;
+    hdr.height = FONT.height();
+    hdr.baseline = FONT.baseline();
+    hdr.count = kept.size();
+    hdr.rowBytes = std::max(1, (maxAdvance + 7)/8);
+    hdr.maxRows = maxRows;
+    hdr.recordSize = (sizeof(BinGlyph) + maxRows*hdr.rowBytes + 3) & ~3;
+
+    out.assign(sizeof(hdr) + kept.size()*hdr.recordSize, 0);
+    memcpy(&out[0], &hdr, sizeof(hdr));
+    for (size_t i = 0; i < kept.size(); i++)
+    {
+        unsigned char* rec = &out[sizeof(hdr) + i*hdr.recordSize];
+        const GlyphCapture &cap = caps[i];
+        BinGlyph g;
+        g.codepoint = kept[i];
+        g.advance = advances[i];
+        g.top = cap.ys.empty() ? 0 : cap.yMin;
+        g.rows = cap.ys.empty() ? 0 : cap.yMax - cap.yMin + 1;
+        g.reserved = 0;
+        memcpy(rec, &g, sizeof(g));
+
+        unsigned char* bits = rec + sizeof(BinGlyph);
+        for (size_t p = 0; p < cap.xs.size(); p++)
+        {
+            if (!cap.fg[p] || cap.xs[p] < 0 || cap.xs[p] >= g.advance)
+                continue;
+            bits[(cap.ys[p] - g.top)*hdr.rowBytes + (cap.xs[p] >> 3)] |= 0x80 >> (cap.xs[p] & 7);
+        }
+    }
+    return true;
+}
+
+
+bool BinFont::write(const string &fname, const Font &FONT, const vector<uint32_t> &codepoints)
+{
+    vector<uint32_t> cps(codepoints);
+    std::sort(cps.begin(), cps.end());
+    cps.erase(std::unique(cps.begin(), cps.end()), cps.end());
+
+    vector<unsigned char> out;
+    if (!pack(FONT, cps, out))
+        return false;
+
+    std::ofstream file(fname.c_str(), std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error. Unable to open " << fname << endl;
+        return false;
+    }
+    file.write((const char*) &out[0], out.size());
+    if (!file.good()) {
+        cerr << "Error. Failed writing " << fname << endl;
+        return false;
+    }
+    return true;
+}
+
+
+uint32_t BinFont::nextCodepoint(const char* &it, const char* END)
+{
+    uint32_t cp = (unsigned char) *it++;
+    int extra = 0;
+    if ((cp & 0xE0) == 0xC0)      { cp &= 0x1F; extra = 1; }
+    else if ((cp & 0xF0) == 0xE0) { cp &= 0x0F; extra = 2; }
+    else if ((cp & 0xF8) == 0xF0) { cp &= 0x07; extra = 3; }
+    else if ((cp & 0xFC) == 0xF8) { cp &= 0x03; extra = 4; }
+    else if ((cp & 0xFE) == 0xFC) { cp &= 0x01; extra = 5; }
+
+    for (; extra > 0 && it < END; extra--)
+        cp = (cp << 6) | ((unsigned char) *it++ & 0x3F);
+    return cp;
+}
+
+
+int DrawText(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+             const char* utf8, int kOff)
+{
+    BinFont::Glyphs glyphs;
+    font.decode(utf8, utf8 + strlen(utf8), glyphs);
+    return DrawText(c, font, x, y, color, backColor, glyphs, kOff);
+}
+
+
+int DrawText(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+             const BinFont::Glyphs &glyphs, int kOff)
+{
+    const int START = x;
+    for (size_t i = 0; i < glyphs.size(); i++)
+        x += font.drawGlyph(c, x, y, color, backColor, glyphs[i]) + kOff;
+    return x - START;
+}
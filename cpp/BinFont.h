@@ -0,0 +1,171 @@
+/*
+	Title: BinFont.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   BinFont class - Precompiled bitmap font, memory mapped instead of parsing a BDF file at startup.
+				Text is decoded from UTF-8 once into glyph indices (BinFont::Glyphs), then measured and drawn from those.
+
+	File layout (little-endian):
+		BinFontHeader                   magic "BFNT", version, font height/baseline, glyph count, record geometry
+		record[count]                   sorted by code point, recordSize bytes each:
+		                                BinGlyph (code point, advance, box top/rows) then maxRows bitmap rows of
+		                                rowBytes each, bit-packed MSB first (bit set = foreground)
+	.bfnt files are built offline from the BDF fonts with bdf2bin (make fonts), keeping only the glyphs we draw.
+*/
+
+
+#ifndef BIN_FONT_H
+#define BIN_FONT_H
+
+#include "graphics.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+using namespace rgb_matrix; using std::string; using std::vector;
+
+const char BIN_FONT_MAGIC[4] = {'B','F','N','T'};
+const uint32_t BIN_FONT_VERSION = 1;
+
+struct BinFontHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint16_t height;        // Font::height()
+    int16_t baseline;       // Font::baseline()
+    uint16_t count;         // Number of glyph records
+    uint16_t rowBytes;      // Bytes per bitmap row
+    uint16_t maxRows;       // Bitmap rows per record
+    uint16_t recordSize;    // sizeof(BinGlyph) + maxRows*rowBytes, rounded up to 4
+};
+
+struct BinGlyph
+{
+    uint32_t codepoint;
+    uint8_t advance;        // Pen advance, also the width of the glyph box
+    int8_t top;             // First row of the glyph box, relative to the baseline y given to DrawGlyph()
+    uint8_t rows;           // Rows in the glyph box
+    uint8_t reserved;
+};
+
+
+//==============// BIN FONT CLASS
+class BinFont
+{
+
+private:
+    // base, length: The records, mapped from a .bfnt file or in built (see LoadFont()). NULL/0 when not loaded.
+    const unsigned char* base;
+    size_t length;
+    bool mapped;
+    // built: Records converted from the BDF when there is no usable .bfnt file
+    vector<unsigned char> built;
+
+    // low: Glyph index of each code point below 256, -1 if the font doesn't have it
+    int low[256];
+    // replacement: Glyph index of U+FFFD, drawn for missing code points (-1 if absent)
+    int replacement;
+
+    // header(): The mapped header
+    const BinFontHeader* header() const { return (const BinFontHeader*) base; }
+
+    // record(): Glyph record i of the mapping
+    const BinGlyph* record(const unsigned int i) const
+    {
+        return (const BinGlyph*) (base + sizeof(BinFontHeader) + (size_t) i*header()->recordSize);
+    }
+
+    // map(): Maps and validates a .bfnt file. Returns false and writes to cerr upon error.
+    bool map(const string &fname);
+
+    // index(): Validates the records at base and fills the lookup tables. NAME is used for errors.
+    bool index(const string &NAME);
+
+    // close(): Unmaps the file and frees built records
+    void close();
+
+    // pack(): Captures the glyphs of FONT for the code points it has (sorted, unique) into .bfnt file contents
+    static bool pack(const Font &FONT, const vector<uint32_t> &cps, vector<unsigned char> &out);
+
+    // Not copyable, the mapping has a single owner
+    BinFont(const BinFont&);
+    BinFont& operator=(const BinFont&);
+
+
+public:
+    // BinFont(): Empty font, call LoadFont()
+    BinFont();
+
+    // ~BinFont(): Calls close()
+    ~BinFont();
+
+    // Glyphs: Decoded text, glyph indices into the font's records
+    typedef vector<uint16_t> Glyphs;
+
+    /*
+    LoadFont(): Loads the font for the BDF file at path. Maps the precompiled file next to it (see binPath()) if
+        there is a valid one, otherwise parses the BDF with the library and converts every glyph it has to records
+        in memory (slower startup, same drawing). Returns false if neither worked.
+    */
+    bool LoadFont(const char* path);
+
+    // isMapped(): True if the font came from a .bfnt file
+    bool isMapped() const { return mapped; }
+
+    // glyphCount(): Number of glyph records, indices run from 0 to glyphCount() - 1
+    int glyphCount() const { return (base != NULL) ? header()->count : 0; }
+
+    // glyphIndex(): Index of the glyph for code point CP, -1 if the font doesn't have it (no fallback)
+    int glyphIndex(const uint32_t CP) const;
+
+    /*
+    decode(): Decodes the UTF-8 from it up to END and appends a glyph per code point to out. Code points the font
+        lacks are substituted: typographic quotes, dashes, ellipsis, bullet and no-break space with their ASCII
+        look-alikes, anything else with U+FFFD. Skipped if there's nothing to draw for them.
+    */
+    void decode(const char* it, const char* END, Glyphs &out) const;
+    void decode(const string &utf8, Glyphs &out) const { decode(utf8.data(), utf8.data() + utf8.size(), out); }
+    // decode(): Same for a single code point
+    void decode(const uint32_t CP, Glyphs &out) const;
+
+    // advance(): Pixels the pen moves for glyph GLYPH
+    int advance(const uint16_t GLYPH) const { return record(GLYPH)->advance; }
+
+    // drawGlyph(): Draws glyph GLYPH at pen x, baseline y. Returns its advance.
+    int drawGlyph(Canvas* c, int x, int y, const Color &color, const Color* backColor, const uint16_t GLYPH) const;
+
+    // Same as rgb_matrix::Font (missing code points draw U+FFFD, no substitutions)
+    int height() const;
+    int baseline() const;
+    int CharacterWidth(const uint32_t CP) const;
+    int DrawGlyph(Canvas* c, int x, int y, const Color &color, const Color* backColor, const uint32_t CP) const;
+    int DrawGlyph(Canvas* c, int x, int y, const Color &color, const uint32_t CP) const
+    {
+        return DrawGlyph(c, x, y, color, NULL, CP);
+    }
+
+    // binPath(): Precompiled file for a BDF file, "../fonts/5x7.bdf" -> "../fonts/5x7.bfnt"
+    static string binPath(const string &BDF_PATH);
+
+    /*
+    write(): Captures the glyphs of FONT for the given code points (ones the font lacks are skipped) through the
+        library's renderer and writes them as a .bfnt file. Returns false and writes to cerr upon error.
+    */
+    static bool write(const string &fname, const Font &FONT, const vector<uint32_t> &codepoints);
+
+    // nextCodepoint(): Decodes the UTF-8 sequence at it and advances it past it, the same way DrawText() does (no
+    //                  validation, a stray byte is its own code point)
+    static uint32_t nextCodepoint(const char* &it, const char* END);
+};
+
+
+// DrawText(): Same as rgb_matrix::DrawText() for a BinFont, except missing glyphs get decode()'s substitutions
+int DrawText(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+             const char* utf8, int kOff = 0);
+
+// DrawText(): Draws decoded text. Returns the advance, kOff included after every glyph like the UTF-8 version.
+int DrawText(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+             const BinFont::Glyphs &glyphs, int kOff = 0);
+
+#endif
@@ -0,0 +1,98 @@
+/*
+	Title: Damage.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the Damage class and clearRect()
+*/
+
+#include "Damage.h"
+#include "SoftCanvas.h"
+#include <algorithm>
+
+
+Damage::Damage(const int W, const int H)
+{
+    w = W;
+    h = H;
+    lo.assign(h, 0);
+    hi.assign(h, 0);
+}
+
+
+void Damage::clear()
+{
+    std::fill(lo.begin(), lo.end(), 0);
+    std::fill(hi.begin(), hi.end(), 0);
+}
+
+
+void Damage::all()
+{
+    std::fill(lo.begin(), lo.end(), 0);
+    std::fill(hi.begin(), hi.end(), w);
+}
+
+
+void Damage::add(const Rect &r)
+{
+    const int X0 = std::max(r.x, 0), X1 = std::min(r.x + r.w, w);
+    const int Y0 = std::max(r.y, 0), Y1 = std::min(r.y + r.h, h);
+    if (X0 >= X1)
+        return;
+    for (int y = Y0; y < Y1; y++)
+    {
+        if (lo[y] >= hi[y]) // Clean row
+        {
+            lo[y] = X0;
+            hi[y] = X1;
+            continue;
+        }
+        if (X0 < lo[y]) lo[y] = X0;
+        if (X1 > hi[y]) hi[y] = X1;
+    }
+}
+
+
+void Damage::add(const Damage &other)
+{
+    const int H = std::min(h, other.h);
+    for (int y = 0; y < H; y++)
+        if (other.lo[y] < other.hi[y])
+            add(Rect(other.lo[y], y, other.hi[y] - other.lo[y], 1));
+}
+
+
+bool Damage::empty() const
+{
+    for (int y = 0; y < h; y++)
+        if (lo[y] < hi[y])
+            return false;
+    return true;
+}
+
+
+int Damage::area() const
+{
+    int total = 0;
+    for (int y = 0; y < h; y++)
+        if (lo[y] < hi[y])
+            total += hi[y] - lo[y];
+    return total;
+}
+
+
+void clearRect(Canvas* c, const Rect &r)
+{
+    SoftCanvas* soft = dynamic_cast<SoftCanvas*>(c);
+    if (soft != NULL)
+    {
+        soft->fillRect(r.x, r.y, r.w, r.h, 0, 0, 0);
+        return;
+    }
+
+    const int X0 = std::max(r.x, 0), X1 = std::min(r.x + r.w, c->width());
+    const int Y0 = std::max(r.y, 0), Y1 = std::min(r.y + r.h, c->height());
+    for (int y = Y0; y < Y1; y++)
+        for (int x = X0; x < X1; x++)
+            c->SetPixel(x, y, 0, 0, 0);
+}
@@ -0,0 +1,87 @@
+/*
+	Title: Damage.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   Rect struct - Rectangle of pixels
+				Damage class - The parts of a frame that changed, as a span of columns per row
+				ClipCanvas class - Passes pixels inside a rectangle through to another canvas, drops the rest
+				clearRect() - Blacks out a rectangle of a canvas
+*/
+
+
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#include "canvas.h"
+#include <stdint.h>
+#include <vector>
+
+using rgb_matrix::Canvas;
+using std::vector;
+
+
+//==============// RECT STRUCT
+struct Rect
+{
+    int x, y, w, h; // Left, top, width, height
+    Rect(const int X = 0, const int Y = 0, const int W = 0, const int H = 0) : x(X), y(Y), w(W), h(H) {}
+};
+
+
+//==============// DAMAGE CLASS
+class Damage
+{
+
+private:
+    int w, h;
+    vector<int16_t> lo, hi;     // Per row, damaged columns [lo, hi). lo >= hi = clean row.
+
+public:
+    // Damage(): Nothing damaged on a W x H frame
+    Damage(const int W = 0, const int H = 0);
+
+    // clear(): Nothing damaged
+    void clear();
+    // all(): The whole frame damaged
+    void all();
+    // add(): Damages r (clipped to the frame). A row's damage grows to the span covering everything added to it.
+    void add(const Rect &r);
+    // add(): Damages everything other has
+    void add(const Damage &other);
+
+    bool empty() const;
+    // area(): Pixels damaged
+    int area() const;
+    int width() const { return w; }
+    int height() const { return h; }
+
+    // rowStart(), rowEnd(): Damaged columns of row y, [start, end)
+    int rowStart(const int y) const { return lo[y]; }
+    int rowEnd(const int y) const { return hi[y]; }
+};
+
+
+//==============// CLIP CANVAS CLASS
+class ClipCanvas : public Canvas
+{
+public:
+    Canvas* c;
+    int x0, y0, x1, y1; // Inclusive, exclusive
+    ClipCanvas(Canvas* canvas, int x, int y, int w, int h) : c(canvas), x0(x), y0(y), x1(x + w), y1(y + h) {}
+    ClipCanvas(Canvas* canvas, const Rect &r) : c(canvas), x0(r.x), y0(r.y), x1(r.x + r.w), y1(r.y + r.h) {}
+    virtual int width() const { return c->width(); }
+    virtual int height() const { return c->height(); }
+    virtual void SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue)
+    {
+        if (x >= x0 && x < x1 && y >= y0 && y < y1)
+            c->SetPixel(x, y, red, green, blue);
+    }
+    virtual void Clear() {}
+    virtual void Fill(uint8_t, uint8_t, uint8_t) {}
+};
+
+
+// clearRect(): Blacks out r on c (clipped to the canvas), a memset per row on a SoftCanvas
+void clearRect(Canvas* c, const Rect &r);
+
+#endif
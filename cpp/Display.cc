@@ -0,0 +1,144 @@
+/*
+	Title: Display.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the Display, MatrixDisplay and SoftDisplay classes
+*/
+
+#include "Display.h"
+#include "AssetLoader.h" // nowUsec()
+#include <cstdio>
+
+
+Display::Display(const int W, const int H) : frame(W, H), whole(W, H)
+{
+    shownHash = 0;
+    shownValid = false;
+    whole.all();
+    swaps = skipped = 0;
+    transferred = 0;
+    hashUsec = 0;
+}
+
+
+Canvas* Display::swap(const Damage* DAMAGE)
+{
+    const double START = AssetLoader::nowUsec();
+    const uint64_t HASH = frame.fingerprint();
+    hashUsec += AssetLoader::nowUsec() - START;
+    swaps++;
+
+    if (shownValid && HASH == shownHash)
+    {
+        skipped++;
+        return &frame;
+    }
+    // The frame before this one is the one showing (or was skipped as identical to it), so pixels outside DAMAGE
+    // already match the output, unless it's outdated
+    const Damage &SEND = (DAMAGE == NULL || !shownValid) ? whole : *DAMAGE;
+    transferred += SEND.area();
+    present(frame, SEND);
+    shownHash = HASH;
+    shownValid = true;
+    return &frame;
+}
+
+
+void Display::setBrightness(const uint8_t BRIGHTNESS)
+{
+    applyBrightness(BRIGHTNESS);
+    outdated(); // Same pixels, but the output has to be set again at the new brightness
+}
+
+
+void Display::printStats() const
+{
+    if (swaps == 0)
+        return;
+    const unsigned long SHOWN = swaps - skipped;
+    fprintf(stderr, "Display: %lu frames, %lu shown, %lu skipped as unchanged (%.1f%%), fingerprint %.2f us/frame\n",
+            swaps, SHOWN, skipped, 100.0*skipped/swaps, hashUsec/swaps);
+    if (SHOWN > 0)
+        fprintf(stderr, "Display: %.1f%% of the panel transferred per frame shown\n",
+                100.0*transferred/SHOWN/(frame.width()*frame.height()));
+}
+
+
+MatrixDisplay::MatrixDisplay(RGBMatrix* m) : Display(m->width(), m->height())
+{
+    this->m = m;
+    off = m->CreateFrameCanvas();
+    offIdx = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        pending[i] = Damage(m->width(), m->height());
+        pending[i].all(); // Nothing composed has reached either buffer yet
+    }
+}
+
+
+void MatrixDisplay::present(const SoftCanvas &FRAME, const Damage &DAMAGE)
+{
+    // off last held the frame before the one showing, so it also needs what changed in that one
+    Damage &behind = pending[offIdx];
+    behind.add(DAMAGE);
+
+    // The library only takes pixels one at a time, so it's one pass over the composed buffer calling FrameCanvas's
+    // SetPixel() directly (qualified, no virtual dispatch)
+    const int W = FRAME.width(), H = FRAME.height();
+    const uint8_t* pixels = FRAME.pixels();
+    for (int y = 0; y < H; y++)
+    {
+        const int X1 = behind.rowEnd(y);
+        const uint8_t* px = pixels + (y*W + behind.rowStart(y))*3;
+        for (int x = behind.rowStart(y); x < X1; x++, px += 3)
+            off->FrameCanvas::SetPixel(x, y, px[0], px[1], px[2]);
+    }
+    behind.clear();
+    pending[!offIdx] = DAMAGE; // Showing now, it'll be off next time
+
+    off = m->SwapOnVSync(off, 1);
+    offIdx = !offIdx;
+}
+
+
+void MatrixDisplay::clear()
+{
+    m->Clear();
+    outdated();
+}
+
+
+SoftDisplay::SoftDisplay(const int W, const int H, const string &DUMP_DIR) : Display(W, H), front(W, H)
+{
+    dumpDir = DUMP_DIR;
+    presented = 0;
+}
+
+
+void SoftDisplay::present(const SoftCanvas &FRAME, const Damage &DAMAGE)
+{
+    const int W = FRAME.width(), H = FRAME.height();
+    const uint8_t* pixels = FRAME.pixels();
+    for (int y = 0; y < H; y++)
+    {
+        const int X0 = DAMAGE.rowStart(y), X1 = DAMAGE.rowEnd(y);
+        if (X0 < X1)
+            front.putRGB(X0, y, pixels + (y*W + X0)*3, X1 - X0);
+    }
+
+    if (!dumpDir.empty())
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "/frame-%06lu.ppm", presented);
+        front.writePPM(dumpDir + name);
+    }
+    presented++;
+}
+
+
+void SoftDisplay::clear()
+{
+    front.Clear();
+    outdated();
+}
@@ -0,0 +1,134 @@
+/*
+	Title: Display.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   Display class - Output the draw code renders to. Frames are composed in a SoftCanvas and fingerprinted,
+				a frame identical to the one showing isn't sent again, and only the damaged spans of one that changed are
+				transferred
+				MatrixDisplay class - The LED panel, through RGBMatrix and its FrameCanvas
+				SoftDisplay class - A SoftCanvas in memory, optionally dumping every shown frame as a PPM
+*/
+
+
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include "led-matrix.h"
+#include "SoftCanvas.h"
+#include "Damage.h"
+#include <string>
+
+using namespace rgb_matrix;
+using std::string;
+
+
+//==============// DISPLAY CLASS
+class Display
+{
+
+private:
+    SoftCanvas frame;       // Composed frame, drawn into between swap() calls
+    uint64_t shownHash;     // Fingerprint of the frame showing
+    bool shownValid;        // false until the first frame, and after anything that changes the output but not frame
+    Damage whole;           // Every pixel, for swaps without damage and outdated output
+
+    // Stats
+    unsigned long swaps, skipped;
+    unsigned long long transferred; // Pixels sent by present()
+    double hashUsec;
+
+
+protected:
+    // present(): Shows FRAME on the output. Pixels outside DAMAGE match the last frame presented.
+    virtual void present(const SoftCanvas &FRAME, const Damage &DAMAGE) = 0;
+    // applyBrightness(): Sets the output's brightness
+    virtual void applyBrightness(const uint8_t BRIGHTNESS) = 0;
+    // outdated(): The output no longer shows the last presented frame, so the next swap() presents regardless
+    void outdated() { shownValid = false; }
+
+
+public:
+    Display(const int W, const int H);
+    virtual ~Display() {}
+
+    // offscreen(): Canvas the next frame is drawn into (the same canvas every frame)
+    Canvas* offscreen() { return &frame; }
+    /*
+    swap(): Shows the offscreen canvas, unless its fingerprint matches the frame already showing (counted as
+        skipped, no transfer or vsync wait). DAMAGE = the pixels changed since the last swap (NULL = all of them).
+        Returns the canvas to draw the next frame into.
+    */
+    Canvas* swap(const Damage* DAMAGE = NULL);
+    // clear(): Blanks what's showing
+    virtual void clear() = 0;
+
+    // setBrightness(), brightness(): Percentage. The next frame is shown even if it's unchanged.
+    void setBrightness(const uint8_t BRIGHTNESS);
+    virtual uint8_t brightness() = 0;
+
+    // matrix(): The panel, for its GPIO inputs. NULL without one.
+    virtual RGBMatrix* matrix() { return NULL; }
+
+    // printStats(): Writes the swaps, how many were skipped as unchanged, the share of the panel transferred per
+    //               frame shown and the fingerprint cost to cerr
+    void printStats() const;
+};
+
+
+//==============// MATRIX DISPLAY CLASS
+class MatrixDisplay : public Display
+{
+
+private:
+    RGBMatrix* m;
+    FrameCanvas* off;
+    Damage pending[2];      // Per FrameCanvas, pixels it's behind the composed frame by
+    int offIdx;             // pending[] entry of off
+
+protected:
+    /*
+    present(): Copies the damaged spans into the FrameCanvas, along with what it missed while the other one was
+        showing, then page flips on the panel's vsync (tied to a fraction of the refresh rate)
+    */
+    void present(const SoftCanvas &FRAME, const Damage &DAMAGE);
+    void applyBrightness(const uint8_t BRIGHTNESS) { m->SetBrightness(BRIGHTNESS); }
+
+public:
+    // MatrixDisplay(): Takes ownership of m
+    MatrixDisplay(RGBMatrix* m);
+    ~MatrixDisplay() { delete m; }
+
+    void clear();
+    uint8_t brightness() { return m->brightness(); }
+    RGBMatrix* matrix() { return m; }
+};
+
+
+//==============// SOFT DISPLAY CLASS
+class SoftDisplay : public Display
+{
+
+private:
+    SoftCanvas front;       // Showing, with the brightness applied
+    string dumpDir;         // Empty = no frame dumps
+    unsigned long presented;
+
+protected:
+    void present(const SoftCanvas &FRAME, const Damage &DAMAGE);
+    void applyBrightness(const uint8_t BRIGHTNESS) { front.setBrightness(BRIGHTNESS); }
+
+public:
+    /*
+    SoftDisplay(): W x H canvas in memory. With DUMP_DIR, every frame shown is written to DUMP_DIR/frame-NNNNNN.ppm
+        (numbered from 0, skipped frames aren't written).
+    */
+    SoftDisplay(const int W, const int H, const string &DUMP_DIR = "");
+
+    void clear();
+    uint8_t brightness() { return front.brightness(); }
+
+    // shown(): The canvas showing
+    const SoftCanvas& shown() const { return front; }
+};
+
+#endif
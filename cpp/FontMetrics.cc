@@ -0,0 +1,89 @@
+/*
+	Title: FontMetrics.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the FontMetrics class
+*/
+
+#include "FontMetrics.h"
+
+
+// registry: Metrics of every font, by address (fonts are globals that live as long as the program)
+static std::map<const BinFont*, FontMetrics*> &registry()
+{
+    static std::map<const BinFont*, FontMetrics*>* reg = new std::map<const BinFont*, FontMetrics*>;
+    return *reg;
+}
+
+
+FontMetrics::FontMetrics(const BinFont &FONT)
+{
+    font = &FONT;
+    widthCount = 0;
+}
+
+
+FontMetrics& FontMetrics::build(const BinFont &FONT)
+{
+    FontMetrics* &m = registry()[&FONT];
+    delete m;
+    m = new FontMetrics(FONT);
+    return *m;
+}
+
+
+FontMetrics& FontMetrics::of(const BinFont &FONT)
+{
+    std::map<const BinFont*, FontMetrics*>::iterator it = registry().find(&FONT);
+    if (it != registry().end())
+        return *it->second;
+    return build(FONT);
+}
+
+
+int FontMetrics::advance(const uint32_t CP)
+{
+    scratch.clear();
+    font->decode(CP, scratch);
+    int total = 0;
+    for (size_t i = 0; i < scratch.size(); i++)
+        total += font->advance(scratch[i]);
+    return total;
+}
+
+
+int FontMetrics::width(const BinFont::Glyphs &glyphs, const int KOFF) const
+{
+    if (glyphs.empty())
+        return 0;
+    int total = 0;
+    for (size_t i = 0; i < glyphs.size(); i++)
+        total += font->advance(glyphs[i]);
+    // Kerning between glyphs, and the last glyph's 1 pixel gap doesn't count
+    return total + KOFF*((int) glyphs.size() - 1) - 1;
+}
+
+
+int FontMetrics::width(const string &utf8, const int KOFF)
+{
+    if (utf8.empty())
+        return 0;
+
+    std::map<string, int> &memo = widths[KOFF];
+    std::map<string, int>::iterator found = memo.find(utf8);
+    if (found != memo.end())
+        return found->second;
+
+    scratch.clear();
+    font->decode(utf8, scratch);
+    const int TOTAL = width(scratch, KOFF);
+
+    if (widthCount >= MAX_WIDTHS)
+    {
+        widths.clear();
+        widthCount = 0;
+    }
+    widths[KOFF][utf8] = TOTAL;
+    widthCount++;
+    return TOTAL;
+}
@@ -0,0 +1,63 @@
+/*
+	Title: FontMetrics.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   FontMetrics class - Widths of decoded text in a loaded BinFont, with memoized string widths
+*/
+
+
+#ifndef FONT_METRICS_H
+#define FONT_METRICS_H
+
+#include "BinFont.h"
+#include <map>
+
+
+//==============// FONT METRICS CLASS
+class FontMetrics
+{
+
+private:
+    const BinFont* font;
+
+    // widths: Memoized width() results by kerning offset, then string (looked up without copying the string)
+    std::map<int, std::map<string, int> > widths;
+    size_t widthCount;
+    static const size_t MAX_WIDTHS = 256; // Memo is dropped past this (strings change with the weather)
+
+    // scratch: Decoding buffer for memo misses
+    BinFont::Glyphs scratch;
+
+    // Not copyable, registered by font address
+    FontMetrics(const FontMetrics&);
+    FontMetrics& operator=(const FontMetrics&);
+
+
+public:
+    // FontMetrics(): Metrics of FONT, which must already be loaded
+    FontMetrics(const BinFont &FONT);
+
+    /*
+    build(): (Re)builds the metrics of FONT and registers them for of(). Call after BinFont::LoadFont(), weather-disp does
+        it in loadFonts().
+    */
+    static FontMetrics& build(const BinFont &FONT);
+
+    // of(): The metrics registered for FONT, built on the spot if build() wasn't called for it
+    static FontMetrics& of(const BinFont &FONT);
+
+    // advance(): Pixels the pen moves for code point CP as BinFont::decode() draws it (substitutions included)
+    int advance(const uint32_t CP);
+
+    /*
+    width(): Pixels the decoded text occupies horizontally when drawn with kerning offset KOFF: the sum of its
+        advances plus KOFF between glyphs, without the trailing 1 pixel gap of the last glyph. 0 for no glyphs.
+    */
+    int width(const BinFont::Glyphs &glyphs, const int KOFF = 0) const;
+
+    // width(): Same for a UTF-8 string, decoded on the first call and memoized per string
+    int width(const string &utf8, const int KOFF = 0);
+
+};
+
+#endif
@@ -0,0 +1,299 @@
+/*
+	Title: Reactor.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the Reactor class
+*/
+
+#include "Reactor.h"
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <cmath>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+
+// MAX_READY: Sources dispatched per epoll_wait()
+static const int MAX_READY = 16;
+
+
+// stdDev(): Standard deviation from a count, sum and sum of squares
+static double stdDev(const unsigned long N, const double SUM, const double SUM_SQ)
+{
+    if (N < 2)
+        return 0;
+    const double MEAN = SUM/N;
+    const double VAR = SUM_SQ/N - MEAN*MEAN;
+    return (VAR > 0) ? sqrt(VAR) : 0;
+}
+
+
+// toTimespec(): Microseconds to a timespec
+static struct timespec toTimespec(const double USEC)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t) (USEC/1e6);
+    ts.tv_nsec = (long) ((USEC - ts.tv_sec*1e6)*1e3);
+    if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+    if (ts.tv_nsec < 0) ts.tv_nsec = 0;
+    return ts;
+}
+
+
+Reactor::Reactor()
+{
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0)
+        perror("Reactor: epoll_create1");
+    waits = 0;
+    blockedUsec = 0;
+}
+
+
+Reactor::~Reactor()
+{
+    for (std::map<int, Source>::iterator it = sources.begin(); it != sources.end(); ++it)
+        close(it->first);
+    if (epfd >= 0)
+        close(epfd);
+}
+
+
+double Reactor::nowUsec(const clockid_t CLOCK)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK, &ts);
+    return ts.tv_sec*1e6 + ts.tv_nsec/1e3;
+}
+
+
+void Reactor::blockSignals(const sigset_t &signals)
+{
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+}
+
+
+int Reactor::add(const int fd, const Source &src)
+{
+    if (fd < 0)
+    {
+        fprintf(stderr, "Reactor: can't create %s source: %s\n", src.name.c_str(), strerror(errno));
+        return -1;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        fprintf(stderr, "Reactor: can't watch %s source: %s\n", src.name.c_str(), strerror(errno));
+        close(fd);
+        return -1;
+    }
+    sources[fd] = src;
+    return fd;
+}
+
+
+int Reactor::addTimer(const string &NAME, Callback cb, void* arg, const clockid_t CLOCK)
+{
+    Source src = Source();
+    src.name = NAME;
+    src.kind = TIMER;
+    src.cb = cb;
+    src.arg = arg;
+    src.clock = CLOCK;
+    return add(timerfd_create(CLOCK, TFD_NONBLOCK | TFD_CLOEXEC), src);
+}
+
+
+void Reactor::armTimer(const int TIMER, const double DELAY_USEC, const double PERIOD_USEC)
+{
+    std::map<int, Source>::iterator it = sources.find(TIMER);
+    if (it == sources.end())
+        return;
+    // Relative arming, computed on the timer's own clock so the lateness stats line up
+    armTimerAt(TIMER, nowUsec(it->second.clock) + ((DELAY_USEC > 0) ? DELAY_USEC : 1), PERIOD_USEC);
+}
+
+
+void Reactor::armTimerAt(const int TIMER, const double AT_USEC, const double PERIOD_USEC)
+{
+    std::map<int, Source>::iterator it = sources.find(TIMER);
+    if (it == sources.end())
+        return;
+    Source &src = it->second;
+
+    struct itimerspec spec;
+    spec.it_value = toTimespec(AT_USEC);
+    spec.it_interval = toTimespec(PERIOD_USEC);
+    // Absolute: the period is kept by the kernel from the first expiry, time spent dispatching doesn't add to it.
+    // A realtime timer also fires early (ECANCELED on read) when the system clock is set, so it re-aligns.
+    int flags = TFD_TIMER_ABSTIME;
+    if (src.clock == CLOCK_REALTIME)
+        flags |= TFD_TIMER_CANCEL_ON_SET;
+    if (timerfd_settime(TIMER, flags, &spec, NULL) != 0)
+    {
+        fprintf(stderr, "Reactor: can't arm %s: %s\n", src.name.c_str(), strerror(errno));
+        return;
+    }
+    src.dueUsec = AT_USEC;
+    src.periodUsec = PERIOD_USEC;
+}
+
+
+void Reactor::disarmTimer(const int TIMER)
+{
+    std::map<int, Source>::iterator it = sources.find(TIMER);
+    if (it == sources.end())
+        return;
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    timerfd_settime(TIMER, 0, &spec, NULL);
+    it->second.dueUsec = 0;
+}
+
+
+bool Reactor::armed(const int TIMER) const
+{
+    std::map<int, Source>::const_iterator it = sources.find(TIMER);
+    return it != sources.end() && it->second.dueUsec != 0;
+}
+
+
+int Reactor::addSignals(const string &NAME, const sigset_t &signals, SignalCallback cb, void* arg)
+{
+    Source src = Source();
+    src.name = NAME;
+    src.kind = SIGNALS;
+    src.sigCb = cb;
+    src.arg = arg;
+    return add(signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC), src);
+}
+
+
+int Reactor::addEvent(const string &NAME, Callback cb, void* arg)
+{
+    Source src = Source();
+    src.name = NAME;
+    src.kind = EVENT;
+    src.cb = cb;
+    src.arg = arg;
+    return add(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC), src);
+}
+
+
+void Reactor::notify(const int EVENT)
+{
+    const uint64_t ONE = 1;
+    if (write(EVENT, &ONE, sizeof(ONE)) < 0 && errno != EAGAIN)
+        perror("Reactor: notify");
+}
+
+
+void Reactor::dispatch(const int fd, Source &src)
+{
+    switch (src.kind)
+    {
+    case TIMER:
+    {
+        uint64_t expirations = 0;
+        if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        {
+            if (errno == ECANCELED) // System clock set, the owner re-arms on the new time
+            {
+                src.dueUsec = 0;
+                src.dispatches++;
+                src.cancels++;
+                src.cb(src.arg);
+            }
+            return; // EAGAIN: disarmed or re-armed since epoll_wait() saw it
+        }
+        // Lateness of the latest expiry, earlier ones are counted as missed
+        const double DUE = src.dueUsec + (expirations - 1)*src.periodUsec;
+        const double LATE = nowUsec(src.clock) - DUE;
+        src.missed += expirations - 1;
+        src.lateSum += LATE;
+        src.lateSumSq += LATE*LATE;
+        if (LATE > src.lateMax)
+            src.lateMax = LATE;
+        src.dueUsec = (src.periodUsec > 0) ? DUE + src.periodUsec : 0;
+        src.dispatches++;
+        src.cb(src.arg);
+    }
+        break;
+
+    case SIGNALS:
+    {
+        struct signalfd_siginfo info;
+        while (read(fd, &info, sizeof(info)) == sizeof(info))
+        {
+            src.dispatches++;
+            src.sigCb(info.ssi_signo, src.arg);
+        }
+    }
+        break;
+
+    case EVENT:
+    {
+        uint64_t count;
+        if (read(fd, &count, sizeof(count)) != sizeof(count))
+            return;
+        src.dispatches++;
+        src.cb(src.arg);
+    }
+        break;
+    }
+}
+
+
+int Reactor::runOnce(const int TIMEOUT_MS)
+{
+    struct epoll_event ready[MAX_READY];
+    const double START = nowUsec(CLOCK_MONOTONIC);
+    const int N = epoll_wait(epfd, ready, MAX_READY, TIMEOUT_MS);
+    blockedUsec += nowUsec(CLOCK_MONOTONIC) - START;
+    waits++;
+    if (N < 0)
+    {
+        if (errno != EINTR)
+            perror("Reactor: epoll_wait");
+        return 0;
+    }
+
+    for (int i = 0; i < N; i++)
+    {
+        std::map<int, Source>::iterator it = sources.find(ready[i].data.fd);
+        if (it != sources.end())
+            dispatch(it->first, it->second);
+    }
+    return N;
+}
+
+
+void Reactor::printStats() const
+{
+    fprintf(stderr, "Reactor: %lu waits, %.1f s blocked\n", waits, blockedUsec/1e6);
+    for (std::map<int, Source>::const_iterator it = sources.begin(); it != sources.end(); ++it)
+    {
+        const Source &src = it->second;
+        const unsigned long EXPIRIES = src.dispatches - src.cancels; // Lateness samples
+        if (src.kind != TIMER || EXPIRIES == 0)
+        {
+            fprintf(stderr, "Reactor: %-10s %lu dispatches", src.name.c_str(), src.dispatches);
+            if (src.cancels > 0)
+                fprintf(stderr, ", %lu cancelled by clock set", src.cancels);
+            fprintf(stderr, "\n");
+            continue;
+        }
+        fprintf(stderr, "Reactor: %-10s %lu dispatches, %.1f us late mean, %.1f us std dev, %.1f us max, %lu missed, "
+                "%lu cancelled by clock set\n",
+                src.name.c_str(), src.dispatches, src.lateSum/EXPIRIES, stdDev(EXPIRIES, src.lateSum, src.lateSumSq),
+                src.lateMax, src.missed, src.cancels);
+    }
+}
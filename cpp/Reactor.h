@@ -0,0 +1,109 @@
+/*
+	Title: Reactor.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   Reactor class - Single threaded event loop on epoll. Timers (timerfd), signals (signalfd) and wakeups
+				from other threads (eventfd) are all file descriptors, waited on together and dispatched to callbacks
+*/
+
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <signal.h>
+#include <time.h>
+#include <map>
+#include <string>
+
+using std::string;
+
+
+//==============// REACTOR CLASS
+class Reactor
+{
+
+public:
+    // Callback: Called by runOnce() with the arg the source was added with
+    typedef void (*Callback)(void* arg);
+    // SignalCallback: Called once per signal read from a signal source
+    typedef void (*SignalCallback)(int signo, void* arg);
+
+
+private:
+    enum Kind { TIMER, SIGNALS, EVENT };
+
+    struct Source
+    {
+        string name;
+        Kind kind;
+        Callback cb;
+        SignalCallback sigCb;
+        void* arg;
+        unsigned long dispatches;
+
+        // Timers
+        clockid_t clock;
+        double periodUsec;  // 0 = one-shot
+        double dueUsec;     // Next expiry on clock, 0 = disarmed
+        unsigned long missed;                   // Expirations folded into a later dispatch
+        unsigned long cancels;                  // Dispatches for the system clock being set (no expiry, no lateness)
+        double lateSum, lateSumSq, lateMax;     // Dispatch time past the expiry
+    };
+
+    int epfd;
+    std::map<int, Source> sources; // By fd
+
+    // Stats
+    unsigned long waits;
+    double blockedUsec;     // Time spent in epoll_wait()
+
+    // add(): Registers fd for reading, returns it (-1 on error, with fd closed)
+    int add(const int fd, const Source &src);
+    // dispatch(): Reads whatever woke fd and calls its callback
+    void dispatch(const int fd, Source &src);
+
+
+public:
+    Reactor();
+    ~Reactor();
+
+    // nowUsec(): Current time on CLOCK in microseconds
+    static double nowUsec(const clockid_t CLOCK);
+
+    /*
+    blockSignals(): Blocks signals in the calling thread and every thread it creates afterwards, so they're only
+        delivered through addSignals(). Call before starting any thread (the matrix and input threads).
+    */
+    static void blockSignals(const sigset_t &signals);
+
+    // addTimer(): Adds a disarmed timer on CLOCK (CLOCK_REALTIME timers follow changes to the system time)
+    int addTimer(const string &NAME, Callback cb, void* arg, const clockid_t CLOCK = CLOCK_MONOTONIC);
+    // armTimer(): First expiry DELAY_USEC from now, then every PERIOD_USEC (0 = once). Replaces any earlier arming.
+    void armTimer(const int TIMER, const double DELAY_USEC, const double PERIOD_USEC = 0);
+    // armTimerAt(): First expiry at AT_USEC on the timer's clock, e.g. whole seconds on CLOCK_REALTIME
+    void armTimerAt(const int TIMER, const double AT_USEC, const double PERIOD_USEC = 0);
+    // disarmTimer(): Stops a timer, an expiry that's already pending is dropped
+    void disarmTimer(const int TIMER);
+    // armed(): true while a timer has an expiry coming
+    bool armed(const int TIMER) const;
+
+    // addSignals(): Reads signals (blocked first with blockSignals()) and calls cb with each signo
+    int addSignals(const string &NAME, const sigset_t &signals, SignalCallback cb, void* arg);
+
+    // addEvent(): Adds a wakeup other threads trigger with notify(). Wakeups before the dispatch are merged.
+    int addEvent(const string &NAME, Callback cb, void* arg);
+    // notify(): Wakes the reactor and runs an event's callback. Safe from any thread and from signal handlers.
+    static void notify(const int EVENT);
+
+    /*
+    runOnce(): Blocks until at least one source is ready (or TIMEOUT_MS passes, -1 = forever), then dispatches every
+        ready source. Returns the number dispatched, 0 on timeout or when a stray signal cut the wait short.
+    */
+    int runOnce(const int TIMEOUT_MS = -1);
+
+    // printStats(): Writes dispatches per source, timer lateness, missed expirations and clock set cancels, and time
+    //               blocked to cerr
+    void printStats() const;
+};
+
+#endif
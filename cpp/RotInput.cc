@@ -29,13 +29,14 @@ const unsigned char ttable[8][4] = {
 };
 
 RotInput::RotInput(pthread_t mainThread, int CLK_PIN, int DT_PIN, int SW_PIN, RGBMatrix* matrix,
-				   int PWR_SW_PIN)
+				   int PWR_SW_PIN, int WAKE_FD)
 {
 	this->mainThread = mainThread;
 	this->CLK_PIN = CLK_PIN;
 	this->DT_PIN = DT_PIN;
 	this->SW_PIN = SW_PIN;
 	this->PWR_SW_PIN = PWR_SW_PIN;
+	this->wakeFd = WAKE_FD;
 	this->matrix = matrix;
 	state = R_START; // Initial State
 	this->event = DIR_NONE;
@@ -116,7 +117,14 @@ void RotInput::processInput()
 		// Send signal to main thread, which will wake from any sleep to handle input event
 		if (newEvent)
 		{
-			pthread_kill(mainThread, SIGUSR1);
+			if (wakeFd >= 0)
+			{
+				uint64_t one = 1;
+				if (write(wakeFd, &one, sizeof(one)) < 0)
+					perror("RotInput: wake");
+			}
+			else
+				pthread_kill(mainThread, SIGUSR1);
 		}
 
 		if (PWR_SW_PIN != -1)
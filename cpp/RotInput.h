@@ -34,9 +34,12 @@ class RotInput
 			The input thread will send SIGUSR1 to mainThread when a new input is recieved, to wakeup
 			any sleeping in mainThread
 			You need to setup a basic signal handler for SIGUSR1 so it is not interpreted as a terminate
+
+			WAKE_FD is optional, an eventfd (Reactor::addEvent()) the input thread writes to instead of
+			sending SIGUSR1, for a main thread waiting on file descriptors
 		*/
 		RotInput(pthread_t mainThread, int CLK_PIN, int DT_PIN, int SW_PIN, RGBMatrix* matrix,
-				 int PWR_SW_PIN = -1);
+				 int PWR_SW_PIN = -1, int WAKE_FD = -1);
 		/* 
 			Destructor:
 			
@@ -60,6 +63,7 @@ class RotInput
 		
 	private:
 		int CLK_PIN, DT_PIN, SW_PIN, PWR_SW_PIN;
+		int wakeFd;
 		RGBMatrix* matrix;
 		
 		pthread_mutex_t stateLock;
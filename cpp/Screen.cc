@@ -0,0 +1,134 @@
+/*
+	Title: Screen.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the Scheduler class
+*/
+
+#include "Screen.h"
+#include "AssetLoader.h" // nowUsec()
+#include <time.h>
+#include <cstdio>
+
+
+// cpuUsec(): CPU time of the calling thread in microseconds
+static double cpuUsec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec*1e6 + ts.tv_nsec/1e3;
+}
+
+
+Scheduler::Scheduler()
+{
+    current = NULL;
+    shownSince = 0;
+    entered = false;
+    dirty = full = false;
+    cad = Screen::STATIC;
+}
+
+
+Scheduler::~Scheduler()
+{
+    for (std::map<int, Entry>::iterator it = screens.begin(); it != screens.end(); ++it)
+        delete it->second.screen;
+}
+
+
+void Scheduler::add(const int ID, Screen* screen)
+{
+    Entry e = Entry();
+    e.screen = screen;
+    screens[ID] = e;
+}
+
+
+void Scheduler::show(const int ID)
+{
+    std::map<int, Entry>::iterator it = screens.find(ID);
+    if (it == screens.end())
+    {
+        fprintf(stderr, "Scheduler: no screen %d\n", ID);
+        return;
+    }
+    const double NOW = AssetLoader::nowUsec();
+    if (current != NULL)
+        current->shownUsec += NOW - shownSince;
+    current = &it->second;
+    shownSince = NOW;
+    entered = false;
+    dirty = full = true;
+}
+
+
+void Scheduler::request(const Screen::Cadence NEED)
+{
+    if (current == NULL)
+        return;
+    if (cad < NEED)
+    {
+        if (!dirty)
+            current->skipped++;
+        return;
+    }
+    dirty = true;
+    if (NEED < Screen::PER_SECOND) // New data, not just time passing
+        full = true;
+}
+
+
+bool Scheduler::render(Canvas* c, Damage &damage)
+{
+    damage.clear();
+    if (current == NULL || !dirty)
+        return false;
+    dirty = false;
+
+    const double START = cpuUsec();
+    if (!entered)
+    {
+        current->screen->enter();
+        entered = true;
+    }
+    if (!full && current->screen->update(c, damage))
+        current->partial++;
+    else
+    {
+        c->Clear();
+        current->screen->draw(c);
+        damage.all();
+    }
+    full = false;
+    cad = current->screen->cadence();
+    current->cpuUsec += cpuUsec() - START;
+    current->frames++;
+    current->repainted += (double) damage.area()/(c->width()*c->height());
+    return true;
+}
+
+
+void Scheduler::printStats()
+{
+    // Close the showing screen's time so far
+    if (current != NULL)
+    {
+        const double NOW = AssetLoader::nowUsec();
+        current->shownUsec += NOW - shownSince;
+        shownSince = NOW;
+    }
+
+    for (std::map<int, Entry>::const_iterator it = screens.begin(); it != screens.end(); ++it)
+    {
+        const Entry &e = it->second;
+        if (e.shownUsec == 0)
+            continue;
+        const double SHOWN_SEC = e.shownUsec/1e6;
+        fprintf(stderr, "Screen %-14s %6lu frames (%.1f/s), %lu skipped, %.1f ms CPU, %.1f us/frame, %.3f%% CPU over %.1f s, "
+                "%lu partial, %.1f%% repainted/frame\n",
+                e.screen->name.c_str(), e.frames, e.frames/SHOWN_SEC, e.skipped, e.cpuUsec/1e3,
+                e.frames ? e.cpuUsec/e.frames : 0.0, 100*e.cpuUsec/e.shownUsec, SHOWN_SEC,
+                e.partial, e.frames ? 100*e.repainted/e.frames : 0.0);
+    }
+}
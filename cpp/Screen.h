@@ -0,0 +1,120 @@
+/*
+	Title: Screen.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   Screen class - One screen of the display, declaring how often it has to be drawn
+				Scheduler class - Draws the showing screen only when its cadence (or an event) calls for it, with
+				per-screen frame, CPU time and repainted area stats
+*/
+
+
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include "canvas.h"
+#include "Damage.h"
+#include <map>
+#include <string>
+
+using rgb_matrix::Canvas;
+using std::string;
+
+
+//==============// SCREEN CLASS
+class Screen
+{
+
+public:
+    // Cadence: When a showing screen has to be drawn again
+    enum Cadence
+    {
+        STATIC,     // Only when invalidated (input, brightness change)
+        ON_DATA,    // Also when the data it shows is updated
+        PER_SECOND, // Also on each second tick of the system clock
+        PER_FRAME   // Also on every animation frame
+    };
+
+    const string name;
+
+    Screen(const string &NAME) : name(NAME) {}
+    virtual ~Screen() {}
+
+    // enter(): Called when the screen comes up, before its first draw (reset scrolling, paging)
+    virtual void enter() {}
+
+    // draw(): Draws the whole screen onto c, which the Scheduler has cleared
+    virtual void draw(Canvas* c) = 0;
+
+    /*
+    update(): On a tick, redraws only what changed since the screen's last frame, which c still holds. Every
+        rectangle touched (cleared first) is added to damage. Returns false, before touching c, to have the whole
+        screen drawn instead (the default).
+    */
+    virtual bool update(Canvas*, Damage&) { return false; }
+
+    // cadence(): Asked after each draw, so a screen can animate only while it needs to (e.g. text too wide to fit)
+    virtual Cadence cadence() const = 0;
+};
+
+
+//==============// SCHEDULER CLASS
+class Scheduler
+{
+
+private:
+    struct Entry
+    {
+        Screen* screen;
+        unsigned long frames;   // Draws
+        unsigned long skipped;  // Data updates and ticks the screen's cadence didn't need a draw for
+        double cpuUsec;         // Thread CPU time spent drawing
+        unsigned long partial;  // Frames done by update()
+        double repainted;       // Sum over frames of the share of the canvas repainted
+        double shownUsec;       // Wall time the screen was showing
+    };
+
+    std::map<int, Entry> screens;   // By screen number
+    Entry* current;
+    double shownSince;
+    bool entered;       // enter() called for the current screen
+    bool dirty;         // Draw on the next render()
+    bool full;          // ...all of it, update() won't do
+    Screen::Cadence cad;  // Of the current screen's last draw
+
+    // request(): Marks the current screen dirty if its cadence is at least NEED, needing a full draw below PER_SECOND
+    void request(const Screen::Cadence NEED);
+
+
+public:
+    Scheduler();
+    // ~Scheduler(): Deletes the screens
+    ~Scheduler();
+
+    // add(): Registers screen as number ID, the Scheduler owns it
+    void add(const int ID, Screen* screen);
+
+    // show(): Switches to screen ID, entering and drawing all of it on the next render()
+    void show(const int ID);
+
+    // invalidate(): The showing screen has to be drawn again regardless of its cadence
+    void invalidate() { dirty = full = true; }
+    // dataChanged(): Data was updated, drawn again unless the screen is STATIC
+    void dataChanged() { request(Screen::ON_DATA); }
+    // tick(): A frame or second timer expired, drawn again if the screen's cadence wants it
+    void tick() { request(Screen::PER_SECOND); }
+
+    /*
+    render(): Draws the current screen onto c if due: its update() on a tick, else a full draw after clearing c.
+        damage is set to what was repainted. Returns true when the caller should swap c in.
+    */
+    bool render(Canvas* c, Damage &damage);
+
+    // cadence(): Of the current screen, as of its last draw (what the frame timers should be armed for)
+    Screen::Cadence cadence() const { return cad; }
+
+    // printStats(): Writes frames, draw CPU time, CPU share of the time shown and share of the canvas repainted per
+    //               frame per screen to cerr
+    void printStats();
+};
+
+#endif
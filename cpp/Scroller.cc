@@ -0,0 +1,121 @@
+/*
+	Title: Scroller.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the Scroller class
+*/
+
+#include "Scroller.h"
+#include "FontMetrics.h"
+#include "AssetLoader.h" // nowUsec()
+#include <cmath>
+
+
+void Scroller::clear()
+{
+    lanes.clear();
+}
+
+
+int Scroller::addLane(const BinFont &FONT, const int y, const Color &color, const double PX_PER_SEC, const int KOFF)
+{
+    Lane lane;
+    lane.font = &FONT;
+    lane.y = y;
+    lane.color = color;
+    lane.pxPerSec = PX_PER_SEC;
+    lane.kOff = KOFF;
+    lane.width = 0;
+    lane.pos = 0;
+    lane.lastUsec = 0;
+    lanes.push_back(lane);
+    return lanes.size() - 1;
+}
+
+
+void Scroller::setText(const int LANE, const string &TEXT)
+{
+    Lane &lane = lanes[LANE];
+    if (TEXT == lane.text)
+        return;
+    lane.text = TEXT;
+    lane.width = FontMetrics::of(*lane.font).width(TEXT, lane.kOff);
+}
+
+
+void Scroller::setEffect(const int LANE, const TextEffect &effect)
+{
+    lanes[LANE].effect = effect;
+}
+
+
+void Scroller::setSpeed(const int LANE, const double PX_PER_SEC)
+{
+    lanes[LANE].pxPerSec = PX_PER_SEC;
+}
+
+
+void Scroller::restart(const int LANE)
+{
+    lanes[LANE].lastUsec = 0;
+}
+
+
+void Scroller::advance(Lane &lane, const int W, const double NOW)
+{
+    if (lane.lastUsec == 0) // First draw, start just off the right edge
+    {
+        lane.pos = W;
+        lane.lastUsec = NOW;
+        return;
+    }
+
+    lane.pos -= lane.pxPerSec*(NOW - lane.lastUsec)/1e6;
+    lane.lastUsec = NOW;
+
+    // Offscreen once the column past the text (and its trailing gap) is left of the canvas, then back to the right.
+    // A slow frame carries the leftover distance across the wrap so the speed stays exact.
+    const double SPAN = W + lane.width + 2;
+    if (lane.pos < -lane.width - 1)
+        lane.pos += SPAN*ceil((-lane.width - 1 - lane.pos)/SPAN);
+}
+
+
+void Scroller::draw(Canvas* c, const int LANE)
+{
+    const double NOW = AssetLoader::nowUsec();
+    const int FIRST = (LANE < 0) ? 0 : LANE;
+    const int LAST = (LANE < 0) ? (int) lanes.size() - 1 : LANE;
+    for (int i = FIRST; i <= LAST; i++)
+    {
+        Lane &lane = lanes[i];
+        advance(lane, c->width(), NOW);
+        if (lane.effect.kind == TextEffect::NONE)
+            TextCache::shared().draw(c, *lane.font, (int) floor(lane.pos), lane.y, lane.color, NULL,
+                                     lane.text.c_str(), lane.kOff);
+        else
+            TextCache::shared().draw(c, *lane.font, (int) floor(lane.pos), lane.y, lane.color, lane.effect,
+                                     lane.text.c_str(), lane.kOff);
+    }
+}
+
+
+int Scroller::x(const int LANE) const
+{
+    return (int) floor(lanes[LANE].pos);
+}
+
+
+Rect Scroller::bounds(const int LANE, const int W) const
+{
+    const Lane &lane = lanes[LANE];
+    int top = lane.y - lane.font->baseline(), h = lane.font->height();
+    if (lane.effect.kind == TextEffect::OUTLINE)
+    {
+        top--;
+        h += 2;
+    }
+    else if (lane.effect.kind == TextEffect::SHADOW)
+        h++;
+    return Rect(0, top, W, h);
+}
@@ -0,0 +1,76 @@
+/*
+	Title: Scroller.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   Scroller class - Scrolling text lanes positioned from the monotonic clock (pixels per second). The
+				frames are paced by the caller (a Reactor timer in weather-disp).
+*/
+
+
+#ifndef SCROLLER_H
+#define SCROLLER_H
+
+#include "BinFont.h"
+#include "TextCache.h"
+#include "Damage.h"
+
+
+//==============// SCROLLER CLASS
+class Scroller
+{
+
+private:
+    // Lane: One line of text moving from offscreen right to offscreen left
+    struct Lane
+    {
+        const BinFont* font;
+        string text;
+        int y;              // Baseline
+        Color color;
+        double pxPerSec;
+        int kOff;
+        TextEffect effect;
+        int width;          // getTotalWidth() of text
+        double pos;         // Sub-pixel x of the text's left edge, drawn at floor(pos)
+        double lastUsec;    // When pos was last advanced, 0 before the first draw
+    };
+
+    vector<Lane> lanes;
+
+    // advance(): Moves the lane by the time since its last draw, wrapping back to the right edge of a W wide canvas
+    void advance(Lane &lane, const int W, const double NOW);
+
+
+public:
+    // clear(): Drops every lane, e.g. on a screen change
+    void clear();
+
+    /*
+    addLane(): Adds a lane drawing with FONT at baseline y, moving PX_PER_SEC pixels per second (fractions are fine).
+        The text starts just off the right edge. Returns the lane number for setText()/draw().
+    */
+    int addLane(const BinFont &FONT, const int y, const Color &color, const double PX_PER_SEC, const int KOFF = 0);
+
+    // setText(): Changes the text of a lane, keeping its position (the weather text changes mid-scroll)
+    void setText(const int LANE, const string &TEXT);
+
+    // setEffect(): Draws a lane with an outline or drop shadow (see TextCache)
+    void setEffect(const int LANE, const TextEffect &effect);
+
+    // setSpeed(): Changes the speed of a lane, keeping its position
+    void setSpeed(const int LANE, const double PX_PER_SEC);
+
+    // restart(): Puts a lane back just off the right edge
+    void restart(const int LANE);
+
+    // draw(): Draws one lane (or every lane for LANE = -1) at the position for the current time
+    void draw(Canvas* c, const int LANE = -1);
+
+    // x(): Pixel column lane LANE was last drawn at
+    int x(const int LANE) const;
+
+    // bounds(): Rows lane LANE's text and effect can touch, across a W wide canvas
+    Rect bounds(const int LANE, const int W) const;
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*
+	Title: SoftCanvas.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the SoftCanvas class
+*/
+
+#include "SoftCanvas.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+
+
+SoftCanvas::SoftCanvas(const int W, const int H)
+{
+    w = W;
+    h = H;
+    bright = 100;
+    bytes = w*h*3;
+    void* buf = NULL;
+    if (posix_memalign(&buf, CACHE_LINE, bytes ? bytes : 1) != 0)
+        throw std::bad_alloc();
+    rgb = (uint8_t*) buf;
+    memset(rgb, 0, bytes);
+}
+
+
+SoftCanvas::~SoftCanvas()
+{
+    free(rgb);
+}
+
+
+void SoftCanvas::SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (x < 0 || y < 0 || x >= w || y >= h)
+        return;
+    uint8_t* px = at(x, y);
+    if (bright >= 100)
+    {
+        px[0] = red;
+        px[1] = green;
+        px[2] = blue;
+        return;
+    }
+    px[0] = red*bright/100;
+    px[1] = green*bright/100;
+    px[2] = blue*bright/100;
+}
+
+
+void SoftCanvas::Clear()
+{
+    memset(rgb, 0, bytes);
+}
+
+
+void SoftCanvas::Fill(uint8_t red, uint8_t green, uint8_t blue)
+{
+    fillRect(0, 0, w, h, red, green, blue);
+}
+
+
+void SoftCanvas::fillRect(const int X, const int Y, const int W, const int H, uint8_t red, uint8_t green, uint8_t blue)
+{
+    const int X0 = std::max(X, 0), X1 = std::min(X + W, w);
+    const int Y0 = std::max(Y, 0), Y1 = std::min(Y + H, h);
+    if (X0 >= X1 || Y0 >= Y1)
+        return;
+    if (bright < 100)
+    {
+        red = red*bright/100;
+        green = green*bright/100;
+        blue = blue*bright/100;
+    }
+
+    const size_t ROW_BYTES = (X1 - X0)*3;
+    if (red == green && green == blue) // Black and grays are one byte repeated
+    {
+        for (int y = Y0; y < Y1; y++)
+            memset(at(X0, y), red, ROW_BYTES);
+        return;
+    }
+
+    // First row from one pixel, doubling the copy each time, then the other rows copy the first
+    uint8_t* first = at(X0, Y0);
+    first[0] = red;
+    first[1] = green;
+    first[2] = blue;
+    for (size_t n = 3; n < ROW_BYTES; n *= 2)
+        memcpy(first + n, first, std::min(n, ROW_BYTES - n));
+    for (int y = Y0 + 1; y < Y1; y++)
+        memcpy(at(X0, y), first, ROW_BYTES);
+}
+
+
+void SoftCanvas::putRGB(const int X, const int Y, const uint8_t* px, const int N)
+{
+    uint8_t* dst = at(X, Y);
+    if (bright >= 100)
+    {
+        memcpy(dst, px, N*3);
+        return;
+    }
+    for (int i = 0; i < N*3; i++)
+        dst[i] = px[i]*bright/100;
+}
+
+
+uint64_t SoftCanvas::fingerprint() const
+{
+    const size_t N = bytes;
+    const uint8_t* p = rgb;
+    uint64_t h = 0xcbf29ce484222325ULL ^ N;
+    size_t i = 0;
+    for (; i + 8 <= N; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, p + i, 8);
+        h = (h ^ word)*0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+    }
+    for (; i < N; i++) // Tail of a canvas whose size isn't a multiple of 8 bytes
+        h = (h ^ p[i])*0x100000001b3ULL;
+    return h;
+}
+
+
+bool SoftCanvas::writePPM(const string &fname) const
+{
+    FILE* f = fopen(fname.c_str(), "wb");
+    if (f == NULL)
+    {
+        perror(fname.c_str());
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", w, h);
+    const bool OK = fwrite(rgb, 1, bytes, f) == bytes;
+    return (fclose(f) == 0) && OK;
+}
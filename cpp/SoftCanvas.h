@@ -0,0 +1,79 @@
+/*
+	Title: SoftCanvas.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   SoftCanvas class - Canvas backed by a contiguous, cache line aligned RGB888 buffer in memory. Every frame
+				is composed in one (see Display), and it renders without the panel (headless runs, benchmarks,
+				frame dumps). Fills and runs of pixels are written straight into the buffer, no SetPixel() per pixel.
+*/
+
+
+#ifndef SOFT_CANVAS_H
+#define SOFT_CANVAS_H
+
+#include "canvas.h"
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+
+using rgb_matrix::Canvas;
+using std::string;
+
+
+//==============// SOFT CANVAS CLASS
+class SoftCanvas : public Canvas
+{
+
+private:
+    int w, h;
+    uint8_t bright;         // 1-100, scales colors as they're set like the matrix library does
+    uint8_t* rgb;           // w*h pixels, 3 bytes each, rows top to bottom, starting on a cache line
+    size_t bytes;
+
+    // Not copyable, owns rgb
+    SoftCanvas(const SoftCanvas&);
+    SoftCanvas& operator=(const SoftCanvas&);
+
+public:
+    // Alignment of the buffer
+    static const size_t CACHE_LINE = 64;
+
+    SoftCanvas(const int W, const int H);
+    ~SoftCanvas();
+
+    // Canvas
+    virtual int width() const { return w; }
+    virtual int height() const { return h; }
+    virtual void SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue);
+    virtual void Clear();
+    virtual void Fill(uint8_t red, uint8_t green, uint8_t blue);
+
+    // fillRect(): Fills a rectangle (clipped to the canvas), memset() per row for grays, else copies of one pixel
+    void fillRect(const int X, const int Y, const int W, const int H, uint8_t red, uint8_t green, uint8_t blue);
+
+    // putRGB(): Writes N packed RGB pixels from px into row y from column x on, which must fit the canvas. One
+    //           memcpy() at full brightness.
+    void putRGB(const int X, const int Y, const uint8_t* px, const int N);
+
+    /*
+    at(): Pointer to pixel (X, Y) in the buffer (no bounds check), for blitters writing runs straight in. Only while
+        scaled() is false, otherwise colors have to go through SetPixel()/putRGB() to be scaled.
+    */
+    uint8_t* at(const int X, const int Y) { return rgb + (Y*w + X)*3; }
+    bool scaled() const { return bright < 100; }
+
+    // setBrightness(): Percentage applied to pixels set afterwards (like RGBMatrix::SetBrightness())
+    void setBrightness(const uint8_t BRIGHTNESS) { bright = BRIGHTNESS; }
+    uint8_t brightness() const { return bright; }
+
+    // pixels(): The buffer, 3 bytes (R, G, B) per pixel, row-major
+    const uint8_t* pixels() const { return rgb; }
+
+    // fingerprint(): 64-bit hash of the pixels, equal for identical frames (mixed a 64-bit word at a time)
+    uint64_t fingerprint() const;
+
+    // writePPM(): Writes the buffer to fname as a binary (P6) PPM. Returns false upon error.
+    bool writePPM(const string &fname) const;
+};
+
+#endif
@@ -0,0 +1,239 @@
+/*
+	Title: TextCache.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the TextCache class
+*/
+
+#include "TextCache.h"
+#include "AssetLoader.h" // nowUsec()
+#include <climits>
+#include <cstdio>
+
+
+// CaptureCanvas: Unbounded canvas that records where DrawText() sets pixels, so a run can be measured and rendered
+class CaptureCanvas : public Canvas
+{
+public:
+	vector<int> xs, ys;
+	int xMin, yMin, xMax, yMax;
+	CaptureCanvas() : xMin(INT_MAX), yMin(INT_MAX), xMax(INT_MIN), yMax(INT_MIN) {}
+	virtual int width() const { return INT_MAX/2; }
+	virtual int height() const { return INT_MAX/2; }
+	virtual void SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue)
+	{
+		xs.push_back(x);
+		ys.push_back(y);
+		xMin = std::min(xMin, x); xMax = std::max(xMax, x);
+		yMin = std::min(yMin, y); yMax = std::max(yMax, y);
+	}
+	virtual void Clear() {}
+	virtual void Fill(uint8_t red, uint8_t green, uint8_t blue) {}
+};
+
+
+TextCache::TextCache(const size_t BUDGET)
+{
+    budget = BUDGET;
+    used = 0;
+    hits = misses = evictions = bypasses = 0;
+    rasterUsec = savedUsec = 0;
+}
+
+
+TextCache::~TextCache()
+{
+    clear();
+}
+
+
+TextCache& TextCache::shared()
+{
+    static TextCache cache;
+    return cache;
+}
+
+
+void TextCache::setBudget(const size_t BYTES)
+{
+    budget = BYTES;
+    evict();
+}
+
+
+TextCache::Entry TextCache::rasterize(const Key &key, const char* utf8)
+{
+    Entry e;
+    e.key = key;
+    e.img = NULL;
+    e.xOff = e.yOff = 0;
+
+    const double START = AssetLoader::nowUsec();
+    const Color COLOR(key.color >> 16, (key.color >> 8) & 0xff, key.color & 0xff);
+    const Color EFFECT(key.effectColor >> 16, (key.effectColor >> 8) & 0xff, key.effectColor & 0xff);
+    CaptureCanvas cap;
+    e.advance = DrawText(&cap, *key.font, 0, 0, COLOR, NULL, utf8, key.kOff);
+
+    if (!cap.xs.empty())
+    {
+        // Bounding box of the set pixels, grown by the effect layer
+        const int PAD_LO = (key.effect == TextEffect::OUTLINE) ? 1 : 0;
+        const int PAD_HI = (key.effect != TextEffect::NONE) ? 1 : 0;
+        const int X0 = cap.xMin - PAD_LO, Y0 = cap.yMin - PAD_LO;
+        const int W = cap.xMax + PAD_HI - X0 + 1;
+        const int H = cap.yMax + PAD_HI - Y0 + 1;
+
+        // Glyph mask, then the effect mask around it (1 = text, 2 = effect)
+        vector<unsigned char> mask(W*H, 0);
+        for (size_t i = 0; i < cap.xs.size(); i++)
+            mask[(cap.ys[i] - Y0)*W + cap.xs[i] - X0] = 1;
+        if (key.effect != TextEffect::NONE)
+        {
+            for (size_t i = 0; i < cap.xs.size(); i++)
+            {
+                const int X = cap.xs[i] - X0, Y = cap.ys[i] - Y0;
+                for (int dy = -PAD_LO; dy <= 1; dy++)
+                    for (int dx = -PAD_LO; dx <= 1; dx++)
+                    {
+                        if (key.effect == TextEffect::SHADOW && (dx != 1 || dy != 1))
+                            continue;
+                        unsigned char &m = mask[(Y + dy)*W + X + dx];
+                        if (m == 0)
+                            m = 2;
+                    }
+            }
+        }
+
+        // Render both layers into one image, palette-indexed by ppm like any icon. A black layer needs the alpha
+        // plane to be told apart from the transparent pixels.
+        vector<unsigned char> rgb(3*W*H, 0);
+        vector<unsigned char> alpha(W*H, 0);
+        for (int i = 0; i < W*H; i++)
+        {
+            if (mask[i] == 0)
+                continue;
+            const Color &c = (mask[i] == 1) ? COLOR : EFFECT;
+            rgb[3*i] = c.r; rgb[3*i + 1] = c.g; rgb[3*i + 2] = c.b;
+            alpha[i] = 255;
+        }
+        e.img = new ppm;
+        e.img->setPixels(W, H, &rgb[0]);
+        const bool BLACK_LAYER = (key.color == 0) || (key.effect != TextEffect::NONE && key.effectColor == 0);
+        if (BLACK_LAYER)
+            e.img->setAlpha(&alpha[0]);
+        e.xOff = X0;
+        e.yOff = Y0;
+    }
+
+    e.rasterUsec = AssetLoader::nowUsec() - START;
+    // The text is held twice, by the entry and by the index
+    e.bytes = sizeof(Entry) + 2*key.text.capacity() + ((e.img != NULL) ? e.img->bytes() : 0);
+    return e;
+}
+
+
+int TextCache::draw(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+                    const char* utf8, int kOff)
+{
+    if (backColor != NULL || (color.r | color.g | color.b) == 0)
+    {
+        bypasses++;
+        return DrawText(c, font, x, y, color, backColor, utf8, kOff);
+    }
+
+    KeyRef ref;
+    ref.font = &font;
+    ref.text = utf8;
+    ref.color = (uint32_t) color.r << 16 | color.g << 8 | color.b;
+    ref.kOff = kOff;
+    ref.effect = TextEffect::NONE;
+    ref.effectColor = 0;
+    return lookup(c, ref, x, y);
+}
+
+
+int TextCache::draw(Canvas* c, const BinFont &font, int x, int y, const Color &color, const TextEffect &effect,
+                    const char* utf8, int kOff)
+{
+    KeyRef ref;
+    ref.font = &font;
+    ref.text = utf8;
+    ref.color = (uint32_t) color.r << 16 | color.g << 8 | color.b;
+    ref.kOff = kOff;
+    ref.effect = effect.kind;
+    ref.effectColor = (effect.kind == TextEffect::NONE) ? 0 :
+                      (uint32_t) effect.color.r << 16 | effect.color.g << 8 | effect.color.b;
+    return lookup(c, ref, x, y);
+}
+
+
+int TextCache::lookup(Canvas* c, const KeyRef &ref, int x, int y)
+{
+    std::map<Key, std::list<Entry>::iterator, KeyLess>::iterator found = index.find(ref);
+    const bool HIT = (found != index.end());
+    if (HIT)
+    {
+        hits++;
+        lru.splice(lru.begin(), lru, found->second);
+    }
+    else
+    {
+        misses++;
+        Key key;
+        key.font = ref.font;
+        key.text = ref.text;
+        key.color = ref.color;
+        key.kOff = ref.kOff;
+        key.effect = ref.effect;
+        key.effectColor = ref.effectColor;
+        lru.push_front(rasterize(key, ref.text));
+        index[lru.front().key] = lru.begin();
+        used += lru.front().bytes;
+        rasterUsec += lru.front().rasterUsec;
+        evict();
+    }
+
+    const Entry &e = lru.front();
+    const double START = HIT ? AssetLoader::nowUsec() : 0;
+    if (e.img != NULL)
+        e.img->draw(c, x + e.xOff, y + e.yOff);
+    if (HIT)
+        savedUsec += e.rasterUsec - (AssetLoader::nowUsec() - START);
+    return e.advance;
+}
+
+
+void TextCache::evict()
+{
+    // Never the front entry, draw() is about to use it
+    while (used > budget && lru.size() > 1)
+    {
+        Entry &e = lru.back();
+        used -= e.bytes;
+        index.erase(e.key);
+        delete e.img;
+        lru.pop_back();
+        evictions++;
+    }
+}
+
+
+void TextCache::clear()
+{
+    for (std::list<Entry>::iterator it = lru.begin(); it != lru.end(); ++it)
+        delete it->img;
+    lru.clear();
+    index.clear();
+    used = 0;
+}
+
+
+void TextCache::printStats(const unsigned long FRAMES) const
+{
+    const unsigned long LOOKUPS = hits + misses;
+    fprintf(stderr, "Text cache: %zu runs, %zu/%zu bytes, %lu hits, %lu misses (%.1f%% hit rate), %lu evictions, "
+            "%lu bypassed\n", lru.size(), used, budget, hits, misses, LOOKUPS ? 100.0*hits/LOOKUPS : 0.0, evictions,
+            bypasses);
+    fprintf(stderr, "Text cache: %.1f ms rendering, %.2f us/frame saved over %lu frames\n", rasterUsec/1e3,
+            FRAMES ? savedUsec/FRAMES : 0.0, FRAMES);
+}
@@ -0,0 +1,155 @@
+/*
+	Title: TextCache.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   TextCache class - LRU cache of pre-rendered text runs, so unchanged strings aren't re-rasterized from
+				the BDF glyphs on every frame
+				TextEffect struct - Outline or drop shadow rendered into a cached run
+*/
+
+
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include "ppm.h"
+#include "BinFont.h"
+#include <map>
+
+
+// TextEffect: Layer drawn behind the text of a run in its own color, so it stays readable over images
+struct TextEffect
+{
+    enum Kind
+    {
+        NONE,
+        OUTLINE,    // Every pixel touching the text, diagonals included (1 pixel dilation)
+        SHADOW      // The text offset 1 pixel right and down
+    };
+    Kind kind;
+    Color color;
+
+    TextEffect() : kind(NONE), color(0, 0, 0) {}
+    TextEffect(const Kind KIND, const Color &COLOR) : kind(KIND), color(COLOR) {}
+};
+
+
+//==============// TEXT CACHE CLASS
+class TextCache
+{
+
+private:
+    // Key: Everything that changes the rendered pixels of a run
+    struct Key
+    {
+        const BinFont* font;
+        string text;
+        uint32_t color;     // 0xRRGGBB
+        int kOff;
+        int effect;         // TextEffect::Kind
+        uint32_t effectColor;
+    };
+
+    // KeyRef: A Key pointing at the caller's text, so lookups don't copy (and allocate) the string every frame
+    struct KeyRef
+    {
+        const BinFont* font;
+        const char* text;
+        uint32_t color;
+        int kOff;
+        int effect;
+        uint32_t effectColor;
+    };
+
+    // KeyLess: Orders Keys, and compares them with KeyRefs for index.find()
+    struct KeyLess
+    {
+        typedef void is_transparent;
+
+        template <typename A, typename B>
+        static bool less(const A &a, const B &b, const int TEXT_CMP)
+        {
+            if (a.font != b.font) return a.font < b.font;
+            if (a.color != b.color) return a.color < b.color;
+            if (a.kOff != b.kOff) return a.kOff < b.kOff;
+            if (a.effect != b.effect) return a.effect < b.effect;
+            if (a.effectColor != b.effectColor) return a.effectColor < b.effectColor;
+            return TEXT_CMP < 0;
+        }
+        bool operator()(const Key &a, const Key &b) const { return less(a, b, a.text.compare(b.text)); }
+        bool operator()(const Key &a, const KeyRef &b) const { return less(a, b, a.text.compare(b.text)); }
+        bool operator()(const KeyRef &a, const Key &b) const { return less(a, b, -b.text.compare(a.text)); }
+    };
+
+    // Entry: A rendered run, effect layer included. img is NULL for runs without any pixels (e.g. spaces).
+    struct Entry
+    {
+        Key key;
+        ppm* img;
+        int xOff, yOff;     // Top-left of img relative to the pen position (x, baseline y) given to DrawText()
+        int advance;        // What DrawText() returned
+        double rasterUsec;  // What rendering it took, saved again on every hit
+        size_t bytes;
+    };
+
+    std::list<Entry> lru;   // Most recently drawn at the front
+    std::map<Key, std::list<Entry>::iterator, KeyLess> index;
+    size_t budget;
+    size_t used;
+
+    // Stats
+    unsigned long hits, misses, evictions, bypasses;
+    double rasterUsec;      // Time spent rendering on misses
+    double savedUsec;       // Rendering time avoided by hits, less the time the blits took
+
+    // rasterize(): Renders a run with DrawText() into a new entry, with its effect layer around the glyph mask
+    Entry rasterize(const Key &key, const char* utf8);
+
+    // lookup(): Draws the run for ref, rendering it on a miss. Returns the advance.
+    int lookup(Canvas* c, const KeyRef &ref, int x, int y);
+
+    // evict(): Drops least recently drawn runs until the cache is within budget
+    void evict();
+
+    // Not copyable, one per budget
+    TextCache(const TextCache&);
+    TextCache& operator=(const TextCache&);
+
+
+public:
+    static const size_t DEF_BUDGET = 64*1024;
+
+    // TextCache(): Cache holding at most BUDGET bytes of rendered runs
+    TextCache(const size_t BUDGET = DEF_BUDGET);
+
+    ~TextCache();
+
+    // shared(): Cache used by the weather-disp draw helpers
+    static TextCache& shared();
+
+    // setBudget(): Changes the byte budget, evicting right away if over
+    void setBudget(const size_t BYTES);
+
+    /*
+    draw(): Same as DrawText() (pen at x, baseline y, returns the advance), but blits the run from the
+        cache, rendering it only the first time. Runs with a background color or drawn in black (which a cached run
+        can't tell from transparent) go straight to DrawText().
+    */
+    int draw(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+             const char* utf8, int kOff = 0);
+
+    /*
+    draw(): Same, with an outline or drop shadow. The effect layer is computed once with the run and blitted with
+        it, so a hit costs about what a plain run does. Black text or effects are drawn too (the run gets an alpha
+        plane), the effect covering whatever is under it.
+    */
+    int draw(Canvas* c, const BinFont &font, int x, int y, const Color &color, const TextEffect &effect,
+             const char* utf8, int kOff = 0);
+
+    // clear(): Drops every run, e.g. after fonts are reloaded
+    void clear();
+
+    // printStats(): Writes the hit rate and the rendering time saved per frame (FRAMES frames drawn) to cerr
+    void printStats(const unsigned long FRAMES) const;
+};
+
+#endif
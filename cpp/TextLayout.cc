@@ -0,0 +1,212 @@
+/*
+	Title: TextLayout.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Contains function definitions for the TextLayout class
+*/
+
+#include "TextLayout.h"
+#include "AssetLoader.h" // nowUsec()
+#include <cmath>
+
+
+TextLayout::TextLayout(const BinFont &FONT, const int X, const int Y_TOP, const int W, const int ROWS, const int KOFF)
+{
+    font = &FONT;
+    kOff = KOFF;
+    x = X;
+    yTop = Y_TOP;
+    width = W;
+    rows = ROWS;
+    holdSec = 3;
+    pxPerSec = 0;
+    startUsec = 0;
+}
+
+
+void TextLayout::setPacing(const double HOLD_SEC, const double PX_PER_SEC)
+{
+    holdSec = HOLD_SEC;
+    pxPerSec = PX_PER_SEC;
+}
+
+
+void TextLayout::restart()
+{
+    startUsec = AssetLoader::nowUsec();
+}
+
+
+void TextLayout::layout(const string &text)
+{
+    lines.clear();
+    lineWidths.clear();
+
+    size_t start = 0;
+    while (start <= text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == string::npos)
+            end = text.size();
+        wrapParagraph(text.substr(start, end - start));
+        start = end + 1;
+    }
+    restart();
+}
+
+
+void TextLayout::addLine(const string &line, const int PEN)
+{
+    lines.push_back(line);
+    // Same measure as FontMetrics::width(): no kerning after the last glyph, nor its 1 pixel gap
+    lineWidths.push_back(line.empty() ? 0 : PEN - kOff - 1);
+}
+
+
+// pen(): Sum of the advances of glyphs, with kOff after each
+static int pen(const BinFont &font, const BinFont::Glyphs &glyphs, const int KOFF)
+{
+    int total = 0;
+    for (size_t i = 0; i < glyphs.size(); i++)
+        total += font.advance(glyphs[i]) + KOFF;
+    return total;
+}
+
+
+void TextLayout::wrapParagraph(const string &para)
+{
+    BinFont::Glyphs glyphs;
+    font->decode(' ', glyphs);
+    const int SPACE = pen(*font, glyphs, kOff);
+    // A line fits while its pen advance, less the trailing kerning and gap, is within the window
+    const int MAX_PEN = width + kOff + 1;
+
+    string line;
+    int linePen = 0;
+    size_t pos = 0;
+    while (pos < para.size())
+    {
+        // Next word, decoded once to measure it
+        if (para[pos] == ' ')
+        {
+            pos++;
+            continue;
+        }
+        size_t end = para.find(' ', pos);
+        if (end == string::npos)
+            end = para.size();
+
+        const char* END = para.c_str() + end;
+        glyphs.clear();
+        font->decode(para.c_str() + pos, END, glyphs);
+        const int WORD_PEN = pen(*font, glyphs, kOff);
+
+        if (line.empty() && WORD_PEN <= MAX_PEN)
+        {
+            line = para.substr(pos, end - pos);
+            linePen = WORD_PEN;
+        }
+        else if (!line.empty() && linePen + SPACE + WORD_PEN <= MAX_PEN)
+        {
+            line += ' ';
+            line.append(para, pos, end - pos);
+            linePen += SPACE + WORD_PEN;
+        }
+        else if (WORD_PEN <= MAX_PEN)
+        {
+            addLine(line, linePen);
+            line = para.substr(pos, end - pos);
+            linePen = WORD_PEN;
+        }
+        else // Longer than the window, break it wherever the line is full
+        {
+            if (!line.empty())
+            {
+                line += ' ';
+                linePen += SPACE;
+            }
+            const char* it = para.c_str() + pos;
+            while (it < END)
+            {
+                const char* cpStart = it;
+                glyphs.clear();
+                font->decode(BinFont::nextCodepoint(it, END), glyphs);
+                const int ADV = pen(*font, glyphs, kOff);
+                if (linePen + ADV > MAX_PEN && !line.empty())
+                {
+                    // A line can't end on the space before the word
+                    if (line[line.size() - 1] == ' ')
+                    {
+                        line.erase(line.size() - 1);
+                        linePen -= SPACE;
+                    }
+                    addLine(line, linePen);
+                    line.clear();
+                    linePen = 0;
+                }
+                line.append(cpStart, it - cpStart);
+                linePen += ADV;
+            }
+        }
+        pos = end;
+    }
+
+    // An empty paragraph still takes a line
+    addLine(line, linePen);
+}
+
+
+void TextLayout::drawLine(Canvas* c, const int i, const int y, const Color &color) const
+{
+    if (lines[i].empty())
+        return;
+    const int X = x + (int) round((width - lineWidths[i])/2.0);
+    if (effect.kind == TextEffect::NONE)
+        TextCache::shared().draw(c, *font, X, y + font->baseline(), color, NULL, lines[i].c_str(), kOff);
+    else
+        TextCache::shared().draw(c, *font, X, y + font->baseline(), color, effect, lines[i].c_str(), kOff);
+}
+
+
+void TextLayout::draw(Canvas* c, const Color &color) const
+{
+    const int N = lines.size();
+    const int LINE_H = font->height();
+    ClipCanvas clip(c, x, yTop, width, rows*LINE_H);
+
+    if (N <= rows) // Fits, nothing to page
+    {
+        for (int i = 0; i < N; i++)
+            drawLine(&clip, i, yTop + i*LINE_H, color);
+        return;
+    }
+
+    const double T = AssetLoader::nowUsec() - startUsec;
+    const double HOLD_USEC = holdSec*1e6;
+
+    if (pxPerSec <= 0) // Flip pages
+    {
+        const int PAGES = (N + rows - 1)/rows;
+        const int PAGE = (HOLD_USEC > 0) ? (long) (T/HOLD_USEC) % PAGES : 0;
+        for (int r = 0; r < rows && PAGE*rows + r < N; r++)
+            drawLine(&clip, PAGE*rows + r, yTop + r*LINE_H, color);
+        return;
+    }
+
+    // Scroll: every line holds at the top of the window, then moves up one line height. A blank line separates the
+    // end from the start.
+    const int CYCLE_LINES = N + 1;
+    const double MOVE_USEC = LINE_H/pxPerSec*1e6;
+    const double STEP_USEC = HOLD_USEC + MOVE_USEC;
+    const double PHASE = fmod(T, CYCLE_LINES*STEP_USEC);
+    const int TOP = (int) (PHASE/STEP_USEC);
+    const double INTO = PHASE - TOP*STEP_USEC;
+    const int SHIFT = (INTO <= HOLD_USEC) ? 0 : (int) floor((INTO - HOLD_USEC)/MOVE_USEC*LINE_H);
+
+    for (int r = 0; r <= rows; r++)
+    {
+        const int i = (TOP + r) % CYCLE_LINES;
+        if (i < N)
+            drawLine(&clip, i, yTop + r*LINE_H - SHIFT, color);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+	Title: TextLayout.h
+	Author: Garrett Carter
+	Date: 10/17/26
+	Contents:   TextLayout class - Word-wraps a string into lines that fit a window of the panel, then pages or scrolls
+				the lines vertically through the window by the monotonic clock
+*/
+
+
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include "BinFont.h"
+#include "TextCache.h"
+#include "Damage.h"
+
+
+//==============// TEXT LAYOUT CLASS
+class TextLayout
+{
+
+private:
+    const BinFont* font;
+    int kOff;
+
+    // Window, in pixels: left x, top y, width, and height in lines of font->height()
+    int x, yTop, width, rows;
+    TextEffect effect;
+
+    // holdSec: How long each page (or each line, when scrolling) stays put
+    double holdSec;
+    // pxPerSec: Speed the lines move up between holds, 0 = flip whole pages
+    double pxPerSec;
+
+    vector<string> lines;
+    vector<int> lineWidths;
+    double startUsec;   // When the current text was laid out, the pacing starts from it
+
+    // wrapParagraph(): Appends the lines of one paragraph (no '\n' in it)
+    void wrapParagraph(const string &para);
+
+    // addLine(): Appends a line, PEN being the sum of its advances including kOff after every character
+    void addLine(const string &line, const int PEN);
+
+    // drawLine(): Draws line i with its top at y, centered in the window
+    void drawLine(Canvas* c, const int i, const int y, const Color &color) const;
+
+
+public:
+    /*
+    TextLayout(): Layout drawn with FONT into the window at (X, Y_TOP), W pixels wide and ROWS lines tall. Lines are
+        centered horizontally. Defaults to flipping pages every 3 seconds.
+    */
+    TextLayout(const BinFont &FONT, const int X, const int Y_TOP, const int W, const int ROWS, const int KOFF = 0);
+
+    // setEffect(): Draws the lines with an outline or drop shadow (see TextCache), clipped to the window like the text
+    void setEffect(const TextEffect &EFFECT) { effect = EFFECT; }
+
+    // setPacing(): Hold each page/line for HOLD_SEC, moving up PX_PER_SEC in between (0 = flip pages)
+    void setPacing(const double HOLD_SEC, const double PX_PER_SEC);
+
+    /*
+    layout(): Wraps text at spaces into lines no wider than the window (measuring each word decoded to glyphs),
+        breaking words that don't fit on a line of their own. '\n' starts a new line. Call when the text changes,
+        not per frame. Restarts the pacing.
+    */
+    void layout(const string &text);
+
+    // restart(): Back to the first line, e.g. on a screen change
+    void restart();
+
+    // lineCount(), line(): The wrapped lines
+    int lineCount() const { return lines.size(); }
+    const string& line(const int i) const { return lines[i]; }
+
+    // animated(): true when the lines don't fit the window, so draw() changes over time and needs paced frames
+    bool animated() const { return (int) lines.size() > rows; }
+
+    // bounds(): The window, everything draw() can touch
+    Rect bounds() const { return Rect(x, yTop, width, rows*font->height()); }
+
+    /*
+    draw(): Draws the lines showing at the current time, clipped to the window. Text that fits the window is drawn
+        still. Longer text cycles through its pages, or scrolls with a blank line between the end and the start.
+    */
+    void draw(Canvas* c, const Color &color) const;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include "Weather.h"
 #include <fstream>
 #include <iostream>
+#include <cstdio>
 
 void WeatherData::init()
 {
@@ -165,4 +166,54 @@ void WeatherData::printDebugData() const
 	cerr << moonPhase 	<< endl;
 	cerr << dewPoint 	<< endl;
 	cerr << lastUpdated << endl;
-}
\ No newline at end of file
+}
+
+
+// formatTime(): strftime() of a UNIX timestamp in local time
+static string formatTime(const char* format, time_t t)
+{
+	char buff[32] = "";
+	struct tm tmStruct;
+	localtime_r(&t, &tmStruct);
+	strftime(buff, sizeof(buff), format, &tmStruct);
+	return buff;
+}
+
+// formatNum(): snprintf() of a single number
+template <typename T>
+static string formatNum(const char* format, T val)
+{
+	char buff[32] = "";
+	snprintf(buff, sizeof(buff), format, val);
+	return buff;
+}
+
+WeatherText::WeatherText(const WeatherData &wd)
+{
+	// WEATHER1
+	highAndLow = 	std::to_string(wd.high) + "F/" + std::to_string(wd.low) + "F";
+	precipChance = 	std::to_string(wd.precipProb) + "%";
+	currTemp = 		std::to_string(wd.temp) + "F";
+	appTemp = 		std::to_string(wd.apparentTemp) + "F";
+	currSummary = 	wd.currSummary;
+
+	// WEATHER2
+	sunrise = 		formatTime("SR-%-I:%M%p", wd.sunrise);
+	sunset = 		formatTime("SS-%-I:%M%p", wd.sunset);
+	moon = 			"MN-" + std::to_string(wd.moonPhase) + "%";
+	uvIndex = 		"UV-" + std::to_string(wd.uvIndex);
+	summaries = 	wd.todaySummary + "\n" + wd.weekSummary;
+
+	// WEATHER3
+	humidity = 		formatNum("HUM-%d%%", wd.humidity);
+	visibility = 	formatNum("VIS-%.1f mi", wd.visibility);
+	wind = 			formatNum("WND-%.1f mph", wd.windGust);
+	direction = 	formatNum("DIR-%d°-", wd.windBearing) + wd.windDir; // ALT-0176
+	updated = 		formatTime("UP-%-m/%-d-%-I:%M%p", wd.lastUpdated);
+
+	// WEATHER4
+	ozone = 		formatNum("OZN-%.1f DU", wd.ozone);
+	pressure = 		formatNum("PRS-%.2f mb", wd.pressure);
+	dewPoint = 		formatNum("DWP-%.2fF", wd.dewPoint);
+	cloudCover = 	formatNum("CLD-%d%%", wd.cloudCover);
+}
@@ -115,4 +115,45 @@ public:
 		
 };
 
+
+/*
+	WeatherText: Every string the weather screens draw, formatted once from a WeatherData when it is read in.
+		weather-disp holds it through a const pointer and replaces it on each update, so drawing a frame does no
+		formatting or allocation.
+*/
+class WeatherText
+{
+
+public:
+	// WEATHER1
+	string highAndLow;		// "75F/60F"
+	string precipChance;	// "20%"
+	string currTemp;
+	string appTemp;
+	string currSummary;
+
+	// WEATHER2
+	string sunrise;			// "SR-6:42AM"
+	string sunset;
+	string moon;			// "MN-45%"
+	string uvIndex;			// "UV-3"
+	string summaries;		// Today and week summaries, one line each (wrapped by weather-disp)
+
+	// WEATHER3
+	string humidity;		// "HUM-65%"
+	string visibility;		// "VIS-10.0 mi"
+	string wind;			// "WND-5.3 mph"
+	string direction;		// "DIR-270°-W"
+	string updated;			// "UP-10/17-3:05PM"
+
+	// WEATHER4
+	string ozone;			// "OZN-300.1 DU"
+	string pressure;		// "PRS-1013.25 mb"
+	string dewPoint;		// "DWP-50.12F"
+	string cloudCover;		// "CLD-40%"
+
+	// WeatherText(): Formats every string from wd (local time for the timestamps)
+	WeatherText(const WeatherData &wd);
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+/*
+	Title: alloc-count.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Replacement global operator new/delete for screen-bench, counting every C++ allocation in the program.
+			 Kept out of screen-bench.cc so the compiler doesn't pair them with the inlined news and deletes of the
+			 code it builds in.
+*/
+
+#include <new>
+#include <cstdlib>
+
+// allocCount, allocBytes: Calls to operator new and bytes asked for, read by screen-bench around each frame
+unsigned long allocCount = 0;
+unsigned long allocBytes = 0;
+
+void* operator new(size_t size)
+{
+	allocCount++;
+	allocBytes += size;
+	void* p = malloc(size ? size : 1);
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
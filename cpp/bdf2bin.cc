@@ -0,0 +1,97 @@
+/*
+	Title: bdf2bin.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Offline converter, turns a BDF font into the precompiled .bfnt format (see BinFont.h) keeping only the
+			 glyphs weather-disp draws. BinFont::LoadFont() picks the .bfnt up automatically when it sits next to the BDF.
+
+	Usage: ./bdf2bin <bdf file> [bfnt file] [code points]
+		code points: comma separated code points or ranges, decimal or 0x hex (default DEF_CODEPOINTS)
+	Example: ./bdf2bin ../rpi-rgb-led-matrix/fonts/5x7.bdf          (writes ../rpi-rgb-led-matrix/fonts/5x7.bfnt)
+*/
+
+#include "BinFont.h"
+#include <iostream>
+#include <cstdlib>
+
+using std::cerr; using std::endl;
+
+// DEF_CODEPOINTS: Printable ASCII, the degree sign, the typographic punctuation in verses and the replacement glyph
+const char* DEF_CODEPOINTS = "0x20-0x7e,0xb0,0x2013-0x2014,0x2018-0x2019,0x201c-0x201d,0x2026,0xfffd";
+
+// parseCodepoints(): Expands "a-b,c,..." into the list. Returns false on malformed input.
+static bool parseCodepoints(const string &SPEC, vector<uint32_t> &cps);
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		cerr << "Usage: " << argv[0] << " <bdf file> [bfnt file] [code points]\n";
+		return 1;
+	}
+
+	const string BDF_FP = argv[1];
+	const string OUT_FP = (argc > 2) ? argv[2] : BinFont::binPath(BDF_FP);
+	const string SPEC = (argc > 3) ? argv[3] : DEF_CODEPOINTS;
+
+	vector<uint32_t> cps;
+	if (!parseCodepoints(SPEC, cps))
+	{
+		cerr << "Bad code point list " << SPEC << endl;
+		return 1;
+	}
+
+	Font font;
+	if (!font.LoadFont(BDF_FP.c_str()))
+	{
+		cerr << "Unable to load " << BDF_FP << endl;
+		return 1;
+	}
+
+	if (!BinFont::write(OUT_FP, font, cps))
+	{
+		cerr << "Font not written\n";
+		return 1;
+	}
+
+	int kept = 0;
+	for (size_t i = 0; i < cps.size(); i++)
+	{
+		if (font.CharacterWidth(cps[i]) >= 0)
+			kept++;
+	}
+	cerr << "Wrote " << kept << " of " << cps.size() << " glyphs from " << BDF_FP << " to " << OUT_FP << endl;
+	return 0;
+}
+
+
+static bool parseCodepoints(const string &SPEC, vector<uint32_t> &cps)
+{
+	const char* p = SPEC.c_str();
+	while (*p)
+	{
+		char* end;
+		unsigned long first = strtoul(p, &end, 0);
+		if (end == p)
+			return false;
+		unsigned long last = first;
+		p = end;
+		if (*p == '-')
+		{
+			last = strtoul(p + 1, &end, 0);
+			if (end == p + 1 || last < first)
+				return false;
+			p = end;
+		}
+		if (last > 0x10ffff)
+			return false;
+		for (unsigned long cp = first; cp <= last; cp++)
+			cps.push_back(cp);
+		if (*p == ',')
+			p++;
+		else if (*p)
+			return false;
+	}
+	return !cps.empty();
+}
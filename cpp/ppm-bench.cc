@@ -0,0 +1,574 @@
+/*
+	Title: ppm-bench.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Benchmark for the image loaders and blitters, using the full weather icon set (same files and count
+			 as weather-disp). Runs without a matrix attached.
+			 Load: time per set for the current ppm::read(), the old byte-at-a-time reader kept here for comparison,
+			 	and Frames (which maps the packed atlas when one exists).
+			 Draw: time per icon for ppm::draw() (clipped opaque spans) against the old per-pixel loop, drawing into
+			 	an in-memory canvas, with the icons fully visible and sliding on/off the panel edges. ppm::draw() into
+			 	a SoftCanvas (runs written straight into its buffer) is timed alongside.
+			 Alpha: time per icon for alpha sprites (the icons with a soft edge added), ppm::draw() with blendRun()
+			 	against a per-pixel blend loop. Drawn into a SoftCanvas over a colored fill, they're checked against
+			 	a per-pixel blend that reads the destination.
+			 Anim: time per frame for the wonder animation, cleared and fully redrawn (as wonder-anim.cc did) against
+			 	Animation's keyframe + deltas, played backwards on two canvases like a double-buffered matrix.
+
+	Usage: ./ppm-bench [-d] [iterations] [icon dir] [icon count]
+		-d: Drop the page cache before the first pass (needs root), to time a cold boot off the SD card
+*/
+
+#include "ppm.h"
+#include "Animation.h"
+#include "SoftCanvas.h"
+#include <time.h>
+#include <unistd.h> // sync
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+//// DEFAULTS (match weather_config.h)
+const string DEF_ICON_DIR = "../img/weather/";
+const int DEF_ICON_CNT = 38;
+const int DEF_ITERATIONS = 50;
+const int DRAW_PASSES = 200; // Draw passes over the icon set per iteration
+const string ANIM_DIR = "../img/wonder/";
+const int ANIM_FRM_CNT = 24;
+
+//// MEMCANVAS: Stand-in for FrameCanvas, same virtual SetPixel with bounds check into a 64x32 buffer
+class MemCanvas : public Canvas
+{
+public:
+	unsigned char px[64*32*3];
+	MemCanvas() { Clear(); }
+	virtual int width() const { return 64; }
+	virtual int height() const { return 32; }
+	virtual void SetPixel(int x, int y, uint8_t red, uint8_t green, uint8_t blue)
+	{
+		if (x < 0 || y < 0 || x >= 64 || y >= 32)
+			return;
+		unsigned char* p = px + 3*(y*64 + x);
+		p[0] = red; p[1] = green; p[2] = blue;
+	}
+	virtual void Clear() { memset(px, 0, sizeof(px)); }
+	virtual void Fill(uint8_t red, uint8_t green, uint8_t blue)
+	{
+		for (int i = 0; i < 64*32; i++) {
+			px[3*i] = red; px[3*i+1] = green; px[3*i+2] = blue;
+		}
+	}
+};
+
+//// FUNCTION PROTOTYPES
+
+// nowUsec(): Monotonic timestamp in microseconds
+static double nowUsec();
+// dropCaches(): Flush dirty pages and drop the page cache so the next pass reads from disk. Returns false if not root.
+static bool dropCaches();
+// legacyRead(): The original ppm::read() pixel loop (three 1-byte istream reads per pixel), for comparison
+static bool legacyRead(ppm &img, const string &fname);
+// loadSet(): Loads every icon in the set with the given reader, returns elapsed usec or -1 on failure
+static double loadSet(bool legacy, const string &dir, int count);
+// loadFrames(): Builds and destroys a Frames object for the set, returns elapsed usec for the load
+static double loadFrames(const string &dir, int count);
+// legacyDraw(): The original ppm::draw() loop (black test + SetPixel per pixel), for comparison
+static void legacyDraw(const ppm &img, Canvas* c, const int xPos, const int yPos);
+// drawSet(): Draws every icon DRAW_PASSES times across the canvas, returns elapsed usec
+//			  slide = true moves the icons across and past the panel edges instead of keeping them visible
+static double drawSet(bool legacy, bool slide, const vector<ppm*> &icons, Canvas* c);
+// makeAlphaIcon(): Copy of the icon with an alpha plane: opaque pixels 255, a half-transparent halo of the
+//				   neighbouring color around them, the rest 0
+static ppm* makeAlphaIcon(const ppm &icon);
+// legacyBlend(): Per-pixel alpha loop (test + divide + SetPixel per pixel), for comparison
+static void legacyBlend(const ppm &img, Canvas* c, const int xPos, const int yPos);
+// blendOver(): Per-pixel alpha blend over the pixels already in c, the reference for ppm::draw() into a SoftCanvas
+static void blendOver(const ppm &img, MemCanvas* c, const int xPos, const int yPos);
+// blendSet(): Draws every alpha icon DRAW_PASSES times, sliding like drawSet(), returns elapsed usec
+static double blendSet(bool legacy, const vector<ppm*> &icons, Canvas* c);
+// benchAnim(): Compares full redraws of the wonder animation with Animation playback, skipped if it isn't on disk
+static void benchAnim(int iterations);
+
+
+int main(int argc, char** argv)
+{
+	int argi = 1;
+	bool cold = false;
+	if (argc > argi && strcmp(argv[argi], "-d") == 0)
+	{
+		cold = true;
+		argi++;
+	}
+	int iterations = 	(argc > argi) ? atoi(argv[argi++]) : DEF_ITERATIONS;
+	string dir = 		(argc > argi) ? argv[argi++] 		: DEF_ICON_DIR;
+	int count = 		(argc > argi) ? atoi(argv[argi++]) : DEF_ICON_CNT;
+
+	if (iterations < 1)
+		iterations = 1;
+
+	fprintf(stderr, "Loading %d icons from %s, %d iterations\n", count, dir.c_str(), iterations);
+
+	if (cold)
+	{
+		if (!dropCaches())
+			fprintf(stderr, "Could not drop page cache (not root?), first pass will be warm\n");
+		double t = loadSet(false, dir, count);
+		if (t < 0)
+			return 1;
+		printf("cold   ppm::read   %9.1f us/set\n", t);
+	}
+
+	const char* NAMES[2] = {"ppm::read ", "legacyRead"};
+	for (int legacy = 0; legacy < 2; legacy++)
+	{
+		double total = 0, best = 1e30;
+		for (int i = 0; i < iterations; i++)
+		{
+			double t = loadSet(legacy, dir, count);
+			if (t < 0)
+				return 1;
+			total += t;
+			if (t < best)
+				best = t;
+		}
+		printf("warm   %s  %9.1f us/set (best %.1f us, %.2f us/icon)\n", NAMES[legacy], total/iterations, best,
+			   total/iterations/count);
+	}
+
+	// Frames, atlas or loose files depending on what is on disk
+	std::ifstream atlasFile(Frames::atlasPath(dir).c_str());
+	const char* SOURCE = atlasFile.good() ? "(atlas)" : "(loose)";
+	double total = 0;
+	for (int i = 0; i < iterations; i++)
+		total += loadFrames(dir, count);
+	printf("warm   Frames %s %9.1f us/set\n", SOURCE, total/iterations);
+
+	//// DRAW
+	vector<ppm*> icons;
+	for (int i = 0; i < count; i++)
+		icons.push_back(new ppm(dir + to_string(i) + ".ppm"));
+
+	size_t opaque = 0, spanCount = 0;
+	for (size_t i = 0; i < icons.size(); i++)
+	{
+		for (size_t k = 0; k < icons[i]->spans.size(); k++)
+			opaque += icons[i]->spans[k].len;
+		spanCount += icons[i]->spans.size();
+	}
+	printf("icons  %zu opaque pixels in %zu spans\n", opaque, spanCount);
+
+	size_t held = 0, rgbBytes = 0, indexed = 0;
+	for (size_t i = 0; i < icons.size(); i++)
+	{
+		held += icons[i]->bytes();
+		rgbBytes += 3*icons[i]->size;
+		if (icons[i]->isIndexed())
+			indexed++;
+	}
+	printf("icons  %zu/%zu indexed, %zu bytes held (%zu as RGB planes), shared palette %u colors\n", indexed,
+		   icons.size(), held, rgbBytes, Palette::shared().count);
+
+	// Both paths must produce the same pixels, including partly offscreen
+	const int CHECK_POS[4][2] = {{3,2}, {-9,-5}, {57,27}, {-15,30}};
+	for (size_t i = 0; i < icons.size(); i++)
+	{
+		for (int p = 0; p < 4; p++)
+		{
+			MemCanvas a, b;
+			SoftCanvas s(64, 32);
+			icons[i]->draw(&a, CHECK_POS[p][0], CHECK_POS[p][1]);
+			legacyDraw(*icons[i], &b, CHECK_POS[p][0], CHECK_POS[p][1]);
+			icons[i]->draw(&s, CHECK_POS[p][0], CHECK_POS[p][1]);
+			if (memcmp(a.px, b.px, sizeof(a.px)) != 0 || memcmp(a.px, s.pixels(), sizeof(a.px)) != 0)
+				fprintf(stderr, "Draw mismatch on icon %zu at %d,%d\n", i, CHECK_POS[p][0], CHECK_POS[p][1]);
+		}
+	}
+
+	MemCanvas canvas;
+	SoftCanvas soft(64, 32);
+	const char* DRAW_NAMES[2] = {"ppm::draw ", "legacyDraw"};
+	const char* MODE_NAMES[2] = {"draw  ", "slide "};
+	for (int slide = 0; slide < 2; slide++)
+	{
+		double perIcon[2];
+		for (int legacy = 0; legacy < 2; legacy++)
+		{
+			double best = 1e30;
+			for (int i = 0; i < iterations; i++)
+			{
+				double t = drawSet(legacy, slide, icons, &canvas);
+				if (t < best)
+					best = t;
+			}
+			perIcon[legacy] = best*1e3/(DRAW_PASSES*count);
+			printf("%s %s  %9.1f ns/icon\n", MODE_NAMES[slide], DRAW_NAMES[legacy], perIcon[legacy]);
+		}
+		printf("%s speedup     %9.2fx\n", MODE_NAMES[slide], perIcon[1]/perIcon[0]);
+
+		double best = 1e30;
+		for (int i = 0; i < iterations; i++)
+		{
+			double t = drawSet(false, slide, icons, &soft);
+			if (t < best)
+				best = t;
+		}
+		printf("%s soft        %9.1f ns/icon\n", MODE_NAMES[slide], best*1e3/(DRAW_PASSES*count));
+	}
+
+	//// ALPHA
+	vector<ppm*> alphaIcons;
+	size_t blendPixels = 0;
+	for (size_t i = 0; i < icons.size(); i++)
+	{
+		alphaIcons.push_back(makeAlphaIcon(*icons[i]));
+		for (size_t k = 0; k < alphaIcons[i]->blendSpans.size(); k++)
+			blendPixels += alphaIcons[i]->blendSpans[k].len;
+	}
+	printf("alpha  %zu blended pixels\n", blendPixels);
+
+	for (size_t i = 0; i < alphaIcons.size(); i++)
+	{
+		for (int p = 0; p < 4; p++)
+		{
+			MemCanvas a, b;
+			SoftCanvas s(64, 32);
+			alphaIcons[i]->draw(&a, CHECK_POS[p][0], CHECK_POS[p][1]);
+			legacyBlend(*alphaIcons[i], &b, CHECK_POS[p][0], CHECK_POS[p][1]);
+			alphaIcons[i]->draw(&s, CHECK_POS[p][0], CHECK_POS[p][1]);
+			if (memcmp(a.px, b.px, sizeof(a.px)) != 0 || memcmp(a.px, s.pixels(), sizeof(a.px)) != 0)
+				fprintf(stderr, "Blend mismatch on icon %zu at %d,%d\n", i, CHECK_POS[p][0], CHECK_POS[p][1]);
+
+			// Over a colored fill, a SoftCanvas blends with what's underneath
+			MemCanvas ref;
+			SoftCanvas over(64, 32);
+			ref.Fill(40, 90, 160);
+			over.Fill(40, 90, 160);
+			blendOver(*alphaIcons[i], &ref, CHECK_POS[p][0], CHECK_POS[p][1]);
+			alphaIcons[i]->draw(&over, CHECK_POS[p][0], CHECK_POS[p][1]);
+			if (memcmp(ref.px, over.pixels(), sizeof(ref.px)) != 0)
+				fprintf(stderr, "Blend over fill mismatch on icon %zu at %d,%d\n", i, CHECK_POS[p][0],
+						CHECK_POS[p][1]);
+		}
+	}
+
+	const char* BLEND_NAMES[2] = {"ppm::draw  ", "legacyBlend"};
+	double perIcon[2];
+	for (int legacy = 0; legacy < 2; legacy++)
+	{
+		double best = 1e30;
+		for (int i = 0; i < iterations; i++)
+		{
+			double t = blendSet(legacy, alphaIcons, &canvas);
+			if (t < best)
+				best = t;
+		}
+		perIcon[legacy] = best*1e3/(DRAW_PASSES*count);
+		printf("alpha  %s %9.1f ns/icon\n", BLEND_NAMES[legacy], perIcon[legacy]);
+	}
+	printf("alpha  speedup     %9.2fx\n", perIcon[1]/perIcon[0]);
+
+	for (size_t i = 0; i < icons.size(); i++)
+	{
+		delete icons[i];
+		delete alphaIcons[i];
+	}
+
+	benchAnim(iterations);
+
+	return 0;
+}
+
+
+static double nowUsec()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1e6 + ts.tv_nsec/1e3;
+}
+
+
+static bool dropCaches()
+{
+	sync();
+	std::ofstream fd("/proc/sys/vm/drop_caches");
+	if (!fd.good())
+		return false;
+	fd << "3\n";
+	return fd.good();
+}
+
+
+static bool legacyRead(ppm &img, const string &fname)
+{
+	std::ifstream inp(fname.c_str(), std::ios::in | std::ios::binary);
+	if (!inp.is_open())
+		return false;
+
+	string line;
+	getline(inp, line);
+	if (line != "P6")
+		return false;
+	getline(inp, line);
+	while (line[0] == '#')
+		getline(inp, line);
+	std::stringstream dimensions(line);
+	dimensions >> img.width >> img.height;
+	getline(inp, line);
+	std::stringstream max_col(line);
+	max_col >> img.max_col_val;
+
+	img.size = img.width*img.height;
+	img.r.resize(img.size);
+	img.g.resize(img.size);
+	img.b.resize(img.size);
+
+	char aux;
+	for (unsigned int i = 0; i < img.size; ++i) {
+		inp.read(&aux, 1);
+		img.r[i] = (unsigned char) aux;
+		inp.read(&aux, 1);
+		img.g[i] = (unsigned char) aux;
+		inp.read(&aux, 1);
+		img.b[i] = (unsigned char) aux;
+	}
+	return inp.good();
+}
+
+
+static double loadSet(bool legacy, const string &dir, int count)
+{
+	vector<ppm*> images;
+	double start = nowUsec();
+	for (int i = 0; i < count; i++)
+	{
+		string fp = dir + to_string(i) + ".ppm";
+		ppm* img = new ppm;
+		bool ok = legacy ? legacyRead(*img, fp) : img->read(fp);
+		if (!ok)
+		{
+			cerr << "Failed to load " << fp << endl;
+			delete img;
+			for (size_t j = 0; j < images.size(); j++)
+				delete images[j];
+			return -1;
+		}
+		images.push_back(img);
+	}
+	double elapsed = nowUsec() - start;
+
+	for (size_t i = 0; i < images.size(); i++)
+		delete images[i];
+	return elapsed;
+}
+
+
+static double loadFrames(const string &dir, int count)
+{
+	double start = nowUsec();
+	Frames* set = new Frames;
+	set->load(dir, count);
+	double elapsed = nowUsec() - start;
+	delete set;
+	return elapsed;
+}
+
+
+static void legacyDraw(const ppm &img, Canvas* c, const int xPos, const int yPos)
+{
+	int i = 0;
+	for (unsigned int yOff = 0; yOff < img.height; yOff++)
+	{
+		for (unsigned int xOff = 0; xOff < img.width; xOff++)
+		{
+			unsigned char red, green, blue;
+			img.pixel(i, red, green, blue);
+			if (red!=0 || green!=0 || blue!=0)
+				c->SetPixel(xPos+xOff, yPos+yOff, red, green, blue);
+			i++;
+		}
+	}
+}
+
+
+static double drawSet(bool legacy, bool slide, const vector<ppm*> &icons, Canvas* c)
+{
+	double start = nowUsec();
+	for (int pass = 0; pass < DRAW_PASSES; pass++)
+	{
+		for (size_t i = 0; i < icons.size(); i++)
+		{
+			// Walk positions over the panel like the screens do
+			int x = (i*16) % 48;
+			int y = (i*8) % 16;
+			if (slide) // From fully off the left/top edge to fully off the right/bottom edge
+			{
+				x = (pass*3 + i*7) % 104 - 20;
+				y = (pass + i*5) % 52 - 10;
+			}
+			if (legacy)
+				legacyDraw(*icons[i], c, x, y);
+			else
+				icons[i]->draw(c, x, y);
+		}
+	}
+	return nowUsec() - start;
+}
+
+
+static ppm* makeAlphaIcon(const ppm &icon)
+{
+	const int W = icon.width, H = icon.height;
+	ppm* img = new ppm(W, H);
+	vector<unsigned char> alpha(img->size, 0);
+	for (int y = 0; y < H; y++)
+	{
+		for (int x = 0; x < W; x++)
+		{
+			const int I = y*W + x;
+			icon.pixel(I, img->r[I], img->g[I], img->b[I]);
+			if (img->r[I] | img->g[I] | img->b[I])
+			{
+				alpha[I] = 255;
+				continue;
+			}
+			// Transparent pixel next to an opaque one: take its color at half strength
+			const int NEIGHBOURS[4][2] = {{-1,0}, {1,0}, {0,-1}, {0,1}};
+			for (int n = 0; n < 4; n++)
+			{
+				const int NX = x + NEIGHBOURS[n][0], NY = y + NEIGHBOURS[n][1];
+				unsigned char red, green, blue;
+				if (NX < 0 || NY < 0 || NX >= W || NY >= H)
+					continue;
+				icon.pixel(NY*W + NX, red, green, blue);
+				if (red | green | blue)
+				{
+					img->r[I] = red; img->g[I] = green; img->b[I] = blue;
+					alpha[I] = 128;
+					break;
+				}
+			}
+		}
+	}
+	img->setAlpha(&alpha[0]);
+	return img;
+}
+
+
+static void legacyBlend(const ppm &img, Canvas* c, const int xPos, const int yPos)
+{
+	int i = 0;
+	for (unsigned int yOff = 0; yOff < img.height; yOff++)
+	{
+		for (unsigned int xOff = 0; xOff < img.width; xOff++, i++)
+		{
+			const unsigned int A = img.aPix[i];
+			if (A == 0)
+				continue;
+			// Over a black backdrop, like ppm::draw()
+			c->SetPixel(xPos+xOff, yPos+yOff, (img.rPix[i]*A + 127)/255, (img.gPix[i]*A + 127)/255,
+						(img.bPix[i]*A + 127)/255);
+		}
+	}
+}
+
+
+static void blendOver(const ppm &img, MemCanvas* c, const int xPos, const int yPos)
+{
+	int i = 0;
+	for (unsigned int yOff = 0; yOff < img.height; yOff++)
+	{
+		for (unsigned int xOff = 0; xOff < img.width; xOff++, i++)
+		{
+			const int X = xPos + xOff, Y = yPos + yOff;
+			const unsigned int A = img.aPix[i];
+			if (A == 0 || X < 0 || Y < 0 || X >= 64 || Y >= 32)
+				continue;
+			unsigned char* d = c->px + 3*(Y*64 + X);
+			const unsigned char SRC[3] = {img.rPix[i], img.gPix[i], img.bPix[i]};
+			for (int ch = 0; ch < 3; ch++)
+				d[ch] = (SRC[ch]*A + d[ch]*(255 - A) + 127)/255;
+		}
+	}
+}
+
+
+static double blendSet(bool legacy, const vector<ppm*> &icons, Canvas* c)
+{
+	double start = nowUsec();
+	for (int pass = 0; pass < DRAW_PASSES; pass++)
+	{
+		for (size_t i = 0; i < icons.size(); i++)
+		{
+			const int X = (pass*3 + i*7) % 104 - 20;
+			const int Y = (pass + i*5) % 52 - 10;
+			if (legacy)
+				legacyBlend(*icons[i], c, X, Y);
+			else
+				icons[i]->draw(c, X, Y);
+		}
+	}
+	return nowUsec() - start;
+}
+
+
+static void benchAnim(int iterations)
+{
+	Frames frames;
+	if (!frames.load(ANIM_DIR, ANIM_FRM_CNT))
+	{
+		fprintf(stderr, "No animation at %s, skipping anim\n", ANIM_DIR.c_str());
+		return;
+	}
+	Animation anim;
+	if (!anim.build(&frames))
+		return;
+
+	const int X = 32 - anim.getWidth()/2;
+	size_t full = 0;
+	for (int f = 0; f < ANIM_FRM_CNT; f++)
+		full += frames.get(f)->bytes();
+	printf("anim   %d frames, %zu bytes as Animation, %zu bytes as Frames, %.1f changed pixels/frame\n",
+		   ANIM_FRM_CNT, anim.bytes(), full, (double) anim.deltaCount()/ANIM_FRM_CNT);
+
+	// Playback must match a full redraw on every frame, on both buffers
+	MemCanvas check[2], ref;
+	for (int n = 0; n < 2*ANIM_FRM_CNT + 3; n++)
+	{
+		const int FRAME = (ANIM_FRM_CNT - n % ANIM_FRM_CNT) % ANIM_FRM_CNT;
+		anim.draw(FRAME, &check[n % 2], X, 0);
+		ref.Clear();
+		frames.draw(FRAME, &ref, X, 0);
+		if (memcmp(check[n % 2].px, ref.px, sizeof(ref.px)) != 0)
+			fprintf(stderr, "Anim mismatch on frame %d\n", FRAME);
+	}
+
+	const char* NAMES[2] = {"full redraw", "Animation  "};
+	double perFrame[2];
+	for (int delta = 0; delta < 2; delta++)
+	{
+		double best = 1e30;
+		for (int i = 0; i < iterations; i++)
+		{
+			MemCanvas buf[2];
+			anim.invalidate();
+			double start = nowUsec();
+			for (int n = 0; n < DRAW_PASSES; n++)
+			{
+				const int FRAME = (ANIM_FRM_CNT - n % ANIM_FRM_CNT) % ANIM_FRM_CNT;
+				if (delta)
+					anim.draw(FRAME, &buf[n % 2], X, 0);
+				else
+				{
+					buf[n % 2].Clear();
+					frames.draw(FRAME, &buf[n % 2], X, 0);
+				}
+			}
+			double t = nowUsec() - start;
+			if (t < best)
+				best = t;
+		}
+		perFrame[delta] = best*1e3/DRAW_PASSES;
+		printf("anim   %s %9.1f ns/frame\n", NAMES[delta], perFrame[delta]);
+	}
+	printf("anim   speedup     %9.2fx\n", perFrame[0]/perFrame[1]);
+}
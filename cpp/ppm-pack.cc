@@ -0,0 +1,167 @@
+/*
+	Title: ppm-pack.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Offline packer, builds a sprite atlas (see Atlas.h) from a numbered set of loose PPM frames.
+			 Frames::load() picks up the atlas automatically when it sits next to the frame directory.
+			 With -c, packs several sets into a C++ source file instead (the embedded bundle linked into weather-disp
+			 by make embed), so startup needs no asset I/O at all.
+
+	Usage: ./ppm-pack <frame filepath> <frame count> [atlas file]
+		   ./ppm-pack -c <output .cc file> <frame filepath>:<frame count> ...
+	Example: ./ppm-pack ../img/weather/ 38          (writes ../img/weather.atlas)
+			 ./ppm-pack -c embedded-assets.cc ../img/weather/:38 ../img/interface/:1
+*/
+
+#include "ppm.h"
+#include <cstdlib>
+#include <cstdio>
+
+// loadSet(): Reads NUM_FRAMES loose frames from FILE_PATH into frames. Returns false if any frame failed.
+static bool loadSet(const string &FILE_PATH, const int NUM_FRAMES, vector<ppm*> &frames);
+// freeSet(): Deletes the frames and empties the vector
+static void freeSet(vector<ppm*> &frames);
+// writeSource(): Packs each "filepath:count" set and writes them as arrays plus the embeddedAssets() table
+static bool writeSource(const string &OUT_FP, const vector<string> &sets);
+
+
+int main(int argc, char** argv)
+{
+	if (argc >= 4 && string(argv[1]) == "-c")
+	{
+		vector<string> sets(argv + 3, argv + argc);
+		if (!writeSource(argv[2], sets))
+		{
+			cerr << "Source not written\n";
+			return 1;
+		}
+		return 0;
+	}
+
+	if (argc < 3)
+	{
+		cerr << "Usage: " << argv[0] << " <frame filepath> <frame count> [atlas file]\n";
+		cerr << "       " << argv[0] << " -c <output .cc file> <frame filepath>:<frame count> ...\n";
+		return 1;
+	}
+
+	const string FILE_PATH = argv[1];
+	const int NUM_FRAMES = atoi(argv[2]);
+	const string OUT_FP = (argc > 3) ? argv[3] : Frames::atlasPath(FILE_PATH);
+
+	if (NUM_FRAMES < 1)
+	{
+		cerr << "Frame count must be at least 1\n";
+		return 1;
+	}
+
+	//// LOAD FRAMES
+	vector<ppm*> frames;
+	bool allGood = loadSet(FILE_PATH, NUM_FRAMES, frames);
+
+	//// PACK
+	size_t bytes = 0;
+	if (allGood)
+	{
+		allGood = Atlas::write(OUT_FP, frames);
+		for (size_t i = 0; i < frames.size(); i++)
+			bytes += 3*frames[i]->size;
+	}
+
+	freeSet(frames);
+
+	if (!allGood)
+	{
+		cerr << "Atlas not written\n";
+		return 1;
+	}
+
+	cerr << "Packed " << NUM_FRAMES << " frames (" << bytes << " pixel bytes) into " << OUT_FP << endl;
+	return 0;
+}
+
+
+static bool loadSet(const string &FILE_PATH, const int NUM_FRAMES, vector<ppm*> &frames)
+{
+	for (int i = 0; i < NUM_FRAMES; i++)
+	{
+		ppm* img = new ppm;
+		frames.push_back(img);
+		if (!img->read(FILE_PATH + to_string(i) + ".ppm"))
+			return false;
+	}
+	return true;
+}
+
+
+static void freeSet(vector<ppm*> &frames)
+{
+	for (size_t i = 0; i < frames.size(); i++)
+		delete frames[i];
+	frames.clear();
+}
+
+
+static bool writeSource(const string &OUT_FP, const vector<string> &sets)
+{
+	FILE* out = fopen(OUT_FP.c_str(), "w");
+	if (out == NULL)
+	{
+		cerr << "Error. Unable to open " << OUT_FP << endl;
+		return false;
+	}
+
+	fprintf(out, "// Generated by ppm-pack -c, do not edit. Rebuild with make embed.\n\n");
+	fprintf(out, "#include \"Atlas.h\"\n\n");
+
+	// One array per set, aligned like an atlas file mapping so frame planes keep their ATLAS_ALIGN alignment
+	vector<string> paths;
+	vector<size_t> lengths;
+	bool allGood = true;
+	for (size_t s = 0; s < sets.size() && allGood; s++)
+	{
+		const size_t SEP = sets[s].rfind(':');
+		const string FILE_PATH = sets[s].substr(0, SEP);
+		const int NUM_FRAMES = (SEP == string::npos) ? 0 : atoi(sets[s].c_str() + SEP + 1);
+		if (NUM_FRAMES < 1)
+		{
+			cerr << "Error. Expected <frame filepath>:<frame count>, got " << sets[s] << endl;
+			allGood = false;
+			break;
+		}
+
+		vector<ppm*> frames;
+		vector<unsigned char> data;
+		allGood = loadSet(FILE_PATH, NUM_FRAMES, frames) && Atlas::pack(frames, data);
+		freeSet(frames);
+		if (!allGood)
+			break;
+
+		fprintf(out, "// %s (%d frames)\n", FILE_PATH.c_str(), NUM_FRAMES);
+		fprintf(out, "alignas(%u) static const unsigned char ASSET_%zu[%zu] = {", ATLAS_ALIGN, s, data.size());
+		for (size_t i = 0; i < data.size(); i++)
+			fprintf(out, "%s%u,", (i % 24 == 0) ? "\n\t" : "", data[i]);
+		fprintf(out, "\n};\n\n");
+
+		paths.push_back(FILE_PATH);
+		lengths.push_back(data.size());
+		cerr << "Embedded " << NUM_FRAMES << " frames (" << data.size() << " bytes) from " << FILE_PATH << endl;
+	}
+
+	if (allGood)
+	{
+		fprintf(out, "static const EmbeddedAsset ASSETS[%zu] = {\n", paths.size());
+		for (size_t s = 0; s < paths.size(); s++)
+			fprintf(out, "\t{\"%s\", ASSET_%zu, %zu},\n", paths[s].c_str(), s, lengths[s]);
+		fprintf(out, "};\n\n");
+
+		fprintf(out, "const EmbeddedAsset* embeddedAssets(int* count)\n{\n");
+		fprintf(out, "\t*count = %zu;\n\treturn ASSETS;\n}\n", paths.size());
+	}
+
+	if (fclose(out) != 0)
+		allGood = false;
+	if (!allGood)
+		remove(OUT_FP.c_str());
+	return allGood;
+}
@@ -2,10 +2,288 @@
 	Title: ppm.cpp
 	Author: Garrett Carter
 	Date: 7/2/19
-	Purpose: Contains function definitions for ppm and Frames classes
+	Purpose: Contains function definitions for ppm, Palette and Frames classes
 */
 
 #include "ppm.h"
+#include "SoftCanvas.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cctype>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <pthread.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+
+//===============// FILE HELPERS
+
+// sharedPaletteLock: Guards additions to Palette::shared() from concurrent decodes
+static pthread_mutex_t sharedPaletteLock = PTHREAD_MUTEX_INITIALIZER;
+
+// PPM_MAX_DIM: Sanity limit on either image dimension, guards against corrupt headers
+static const unsigned long PPM_MAX_DIM = 4096;
+
+/*
+	readHeaderField(): Parses the next unsigned decimal field of a PNM header starting at pos, skipping
+		whitespace and '#' comments. pos is left on the byte following the field. Returns false on malformed input.
+*/
+static bool readHeaderField(const vector<unsigned char> &buf, size_t &pos, unsigned long &val)
+{
+    const size_t END = buf.size();
+    while (pos < END)
+    {
+        if (buf[pos] == '#') // Comment runs to end of line
+        {
+            while (pos < END && buf[pos] != '\n')
+                pos++;
+        }
+        else if (isspace(buf[pos]))
+            pos++;
+        else
+            break;
+    }
+
+    if (pos >= END || !isdigit(buf[pos]))
+        return false;
+
+    val = 0;
+    while (pos < END && isdigit(buf[pos]))
+    {
+        val = val*10 + (buf[pos] - '0');
+        if (val > 0xffffff) // Way beyond anything valid, stop before overflow
+            return false;
+        pos++;
+    }
+    return true;
+}
+
+/*
+	deinterleaveRGB(): Splits packed RGBRGB... samples into the three channel planes.
+		Uses NEON structure loads (16 pixels per iteration) when available, scalar loop otherwise.
+*/
+static void deinterleaveRGB(const unsigned char* src, unsigned char* r, unsigned char* g, unsigned char* b, size_t n)
+{
+    size_t i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16x3_t px = vld3q_u8(src + 3*i);
+        vst1q_u8(r + i, px.val[0]);
+        vst1q_u8(g + i, px.val[1]);
+        vst1q_u8(b + i, px.val[2]);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        r[i] = src[3*i];
+        g[i] = src[3*i + 1];
+        b[i] = src[3*i + 2];
+    }
+}
+
+
+// deinterleaveRGBA(): Same as deinterleaveRGB() for packed RGBARGBA... samples
+static void deinterleaveRGBA(const unsigned char* src, unsigned char* r, unsigned char* g, unsigned char* b,
+                             unsigned char* a, size_t n)
+{
+    size_t i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16x4_t px = vld4q_u8(src + 4*i);
+        vst1q_u8(r + i, px.val[0]);
+        vst1q_u8(g + i, px.val[1]);
+        vst1q_u8(b + i, px.val[2]);
+        vst1q_u8(a + i, px.val[3]);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        r[i] = src[4*i];
+        g[i] = src[4*i + 1];
+        b[i] = src[4*i + 2];
+        a[i] = src[4*i + 3];
+    }
+}
+
+// interleaveRGB(): The reverse of deinterleaveRGB(), packs n pixels of the channel planes into RGBRGB... at dst
+static void interleaveRGB(const unsigned char* r, const unsigned char* g, const unsigned char* b, unsigned char* dst,
+                          size_t n)
+{
+    size_t i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16x3_t px;
+        px.val[0] = vld1q_u8(r + i);
+        px.val[1] = vld1q_u8(g + i);
+        px.val[2] = vld1q_u8(b + i);
+        vst3q_u8(dst + 3*i, px);
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[3*i] = r[i];
+        dst[3*i + 1] = g[i];
+        dst[3*i + 2] = b[i];
+    }
+}
+
+/*
+	readPamHeader(): Parses the PAM (P7) header lines following the magic, up to and including "ENDHDR\n".
+		fields gets WIDTH, HEIGHT, MAXVAL and DEPTH, alpha is set for TUPLTYPE RGB_ALPHA. pos is left on the
+		first payload byte. Returns false on malformed input.
+*/
+static bool readPamHeader(const vector<unsigned char> &buf, size_t &pos, unsigned long fields[3],
+                          unsigned long &depth, bool &alpha)
+{
+    const size_t END = buf.size();
+    bool seen[4] = {false, false, false, false};
+    alpha = false;
+    while (true)
+    {
+        // Next token, skipping whitespace and comment lines
+        while (pos < END && (isspace(buf[pos]) || buf[pos] == '#'))
+        {
+            if (buf[pos] == '#')
+                while (pos < END && buf[pos] != '\n')
+                    pos++;
+            else
+                pos++;
+        }
+        size_t start = pos;
+        while (pos < END && !isspace(buf[pos]))
+            pos++;
+        const string KEY(buf.begin() + start, buf.begin() + pos);
+        if (KEY.empty())
+            return false;
+
+        if (KEY == "ENDHDR")
+        {
+            if (pos >= END || buf[pos] != '\n')
+                return false;
+            pos++;
+            return seen[0] && seen[1] && seen[2] && seen[3];
+        }
+
+        // Value runs to the end of the line
+        while (pos < END && (buf[pos] == ' ' || buf[pos] == '\t'))
+            pos++;
+        start = pos;
+        while (pos < END && buf[pos] != '\n')
+            pos++;
+        string val(buf.begin() + start, buf.begin() + pos);
+        while (!val.empty() && isspace(val[val.size() - 1]))
+            val.erase(val.size() - 1);
+
+        if (KEY == "TUPLTYPE")
+        {
+            if (val == "RGB_ALPHA")
+                alpha = true;
+            else if (val != "RGB")
+                return false;
+            continue;
+        }
+
+        const char* NAMES[4] = {"WIDTH", "HEIGHT", "MAXVAL", "DEPTH"};
+        int f = 0;
+        while (f < 4 && KEY != NAMES[f])
+            f++;
+        if (f == 4 || val.empty() || val.find_first_not_of("0123456789") != string::npos)
+            return false;
+        unsigned long n = strtoul(val.c_str(), NULL, 10);
+        if (f == 3)
+            depth = n;
+        else
+            fields[f] = n;
+        seen[f] = true;
+    }
+}
+
+void blendRun(const unsigned char* srcR, const unsigned char* srcG, const unsigned char* srcB,
+              const unsigned char* alpha, unsigned char* dstR, unsigned char* dstG, unsigned char* dstB,
+              const size_t N)
+{
+    const unsigned char* src[3] = {srcR, srcG, srcB};
+    unsigned char* dst[3] = {dstR, dstG, dstB};
+    size_t i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    // t = s*a + d*(255-a) in 16 bits, then t/255 rounded as (t + 128 + ((t + 128) >> 8)) >> 8
+    const uint16x8_t ROUND = vdupq_n_u16(128);
+    for (; i + 16 <= N; i += 16)
+    {
+        const uint8x16_t A = vld1q_u8(alpha + i);
+        const uint8x16_t INV = vmvnq_u8(A);
+        for (int ch = 0; ch < 3; ch++)
+        {
+            const uint8x16_t S = vld1q_u8(src[ch] + i);
+            const uint8x16_t D = vld1q_u8(dst[ch] + i);
+            uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(S), vget_low_u8(A)), vget_low_u8(D), vget_low_u8(INV));
+            uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(S), vget_high_u8(A)), vget_high_u8(D), vget_high_u8(INV));
+            lo = vaddq_u16(lo, ROUND);
+            hi = vaddq_u16(hi, ROUND);
+            lo = vsraq_n_u16(lo, lo, 8);
+            hi = vsraq_n_u16(hi, hi, 8);
+            vst1q_u8(dst[ch] + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+        }
+    }
+#endif
+    for (; i < N; i++)
+    {
+        const unsigned int A = alpha[i];
+        for (int ch = 0; ch < 3; ch++)
+        {
+            unsigned int t = src[ch][i]*A + dst[ch][i]*(255 - A) + 128;
+            dst[ch][i] = (t + (t >> 8)) >> 8;
+        }
+    }
+}
+
+
+//===============// PALETTE STRUCT
+
+Palette::Palette()
+{
+    r[0] = g[0] = b[0] = 0;
+    count = 1;
+}
+
+
+int Palette::find(const uint32_t RGB) const
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (((uint32_t) r[i] << 16 | g[i] << 8 | b[i]) == RGB)
+            return i;
+    }
+    return -1;
+}
+
+
+int Palette::add(const uint32_t RGB)
+{
+    if (count >= 256)
+        return -1;
+    r[count] = RGB >> 16;
+    g[count] = RGB >> 8;
+    b[count] = RGB;
+    return count++;
+}
+
+
+Palette& Palette::shared()
+{
+    // Function static, icon sets may be loaded during static initialization
+    static Palette pal;
+    return pal;
+}
 
 
 //===============// PPM CLASS
@@ -14,6 +292,34 @@ void ppm::init() {
     width = 0;
     height = 0;
     max_col_val = 255;
+    size = 0;
+    rPix = gPix = bPix = NULL;
+    aPix = NULL;
+    idxPix = NULL;
+    palette = NULL;
+    ownPalette = NULL;
+}
+
+
+void ppm::bindPlanes() {
+    rPix = r.empty() ? NULL : &r[0];
+    gPix = g.empty() ? NULL : &g[0];
+    bPix = b.empty() ? NULL : &b[0];
+    aPix = a.empty() ? NULL : &a[0];
+}
+
+
+void ppm::releasePixels() {
+    vector<unsigned char>().swap(r);
+    vector<unsigned char>().swap(g);
+    vector<unsigned char>().swap(b);
+    vector<unsigned char>().swap(a);
+    vector<unsigned char>().swap(idx);
+    delete ownPalette;
+    ownPalette = NULL;
+    rPix = gPix = bPix = aPix = NULL;
+    idxPix = NULL;
+    palette = NULL;
 }
 
 
@@ -22,6 +328,11 @@ ppm::ppm() {
 }
 
 
+ppm::~ppm() {
+    delete ownPalette;
+}
+
+
 ppm::ppm(const string &fname) {
     init();
     read(fname);
@@ -39,100 +350,333 @@ ppm::ppm(const unsigned int _width, const unsigned int _height) {
     r.resize(size);
     g.resize(size);
     b.resize(size);
+    bindPlanes();
+    buildSpans();
 }
 
 
 bool ppm::read(const string &fname)
 {
-    std::ifstream inp(fname.c_str(), std::ios::in | std::ios::binary);
-    if (inp.is_open()) {
-        string line;
-        getline(inp, line);
-        if (line != "P6") {
-            cerr << "Error. Unrecognized file format." << endl;
-            inp.close();
+    // Pull the whole file into memory with a single read() (icons are a few hundred bytes)
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error. Unable to open " << fname << endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        cerr << "Error. Unable to stat " << fname << endl;
+        close(fd);
+        return false;
+    }
+
+    vector<unsigned char> file(st.st_size);
+    size_t got = 0;
+    while (got < file.size()) // Normally completes in one call, loop handles short reads
+    {
+        ssize_t n = ::read(fd, &file[got], file.size() - got);
+        if (n <= 0)
+            break;
+        got += n;
+    }
+    close(fd);
+
+    if (got != file.size()) {
+        cerr << "Error. Short read on " << fname << endl;
+        return false;
+    }
+
+    // Header: "P6" <ws> width <ws> height <ws> maxval <single ws> <payload>
+    //     or "P7\n" WIDTH/HEIGHT/DEPTH/MAXVAL/TUPLTYPE lines, "ENDHDR\n" <payload>
+    size_t pos = 0;
+    unsigned long fields[3];
+    unsigned long depth = 3;
+    bool alpha = false;
+    if (file.size() < 2 || file[0] != 'P' || (file[1] != '6' && file[1] != '7')) {
+        cerr << "Error. Unrecognized file format." << endl;
+        return false;
+    }
+    pos = 2;
+    if (file[1] == '7')
+    {
+        if (!readPamHeader(file, pos, fields, depth, alpha) || depth != (alpha ? 4u : 3u)) {
+            cerr << "Header file format error in " << fname << endl;
             return false;
         }
-        getline(inp, line);
-        while (line[0] == '#') {
-            getline(inp, line); // Ignore comment lines
+    }
+    else
+    {
+        for (int f = 0; f < 3; f++)
+        {
+            if (!readHeaderField(file, pos, fields[f])) {
+                cerr << "Header file format error in " << fname << endl;
+                return false;
+            }
         }
-        std::stringstream dimensions(line);
-
-        try {
-            dimensions >> width;
-			if (!dimensions.eof())
-			{
-				dimensions >> height;
-			}
-			else // Handle case of width on next line
-			{
-				getline(inp, line);
-				dimensions.str(line);
-				dimensions >> height;
-			}
-        } catch (std::exception &e) {
-            cerr << "Header file format error. " << e.what() << endl;
-            inp.close();
+        // Exactly one whitespace byte separates maxval from the payload
+        if (pos >= file.size() || !isspace(file[pos])) {
+            cerr << "Header file format error in " << fname << endl;
             return false;
         }
+        pos++;
+    }
 
-		getline(inp, line); // Remove last newline before data
-		std::stringstream max_col(line);
-		
-        try {
-            max_col >> max_col_val;
-        } catch (std::exception &e) {
-            cerr << "Header file format error. " << e.what() << endl;
-            inp.close();
-            return false;
-        }
+    if (fields[0] == 0 || fields[1] == 0 || fields[0] > PPM_MAX_DIM || fields[1] > PPM_MAX_DIM) {
+        cerr << "Error. Bad dimensions " << fields[0] << "x" << fields[1] << " in " << fname << endl;
+        return false;
+    }
+    if (fields[2] == 0 || fields[2] > 255) { // 16-bit samples are not supported
+        cerr << "Error. Unsupported max color value " << fields[2] << " in " << fname << endl;
+        return false;
+    }
+
+    const size_t pixels = fields[0]*fields[1];
+    if (file.size() - pos < pixels*depth) {
+        cerr << "Error. Truncated pixel data in " << fname << endl;
+        return false;
+    }
 
-        size = width*height;
+    if (alpha) // Alpha images stay as planes for the blend kernel
+    {
+        releasePixels();
+        width = fields[0];
+        height = fields[1];
+        size = pixels;
+        r.resize(size);
+        g.resize(size);
+        b.resize(size);
+        a.resize(size);
+        deinterleaveRGBA(&file[pos], &r[0], &g[0], &b[0], &a[0], size);
+        bindPlanes();
+        buildSpans();
+    }
+    else
+        setPixels(fields[0], fields[1], &file[pos]);
+    max_col_val = fields[2];
 
-        r.reserve(size);
-        g.reserve(size);
-        b.reserve(size);
+    // Read operation was successful
+    return true;
+}
 
-        char aux;
-        for (unsigned int i = 0; i < size; ++i) {
-            inp.read(&aux, 1);
-            r[i] = (unsigned char) aux;
-            inp.read(&aux, 1);
-            g[i] = (unsigned char) aux;
-            inp.read(&aux, 1);
-            b[i] = (unsigned char) aux;
+
+void ppm::setPixels(const unsigned int _width, const unsigned int _height, const unsigned char* rgb)
+{
+    releasePixels();
+    width = _width;
+    height = _height;
+    size = width*height;
+    max_col_val = 255;
+
+    if (!indexPixels(rgb)) // Too many colors for a palette, keep full RGB planes
+    {
+        r.resize(size);
+        g.resize(size);
+        b.resize(size);
+        deinterleaveRGB(rgb, &r[0], &g[0], &b[0], size);
+        bindPlanes();
+    }
+    buildSpans();
+}
+
+
+void ppm::wrap(const unsigned int _width, const unsigned int _height,
+               const unsigned char* _r, const unsigned char* _g, const unsigned char* _b)
+{
+    releasePixels();
+
+    width = _width;
+    height = _height;
+    size = width*height;
+    max_col_val = 255;
+    rPix = _r;
+    gPix = _g;
+    bPix = _b;
+    buildSpans();
+}
+
+
+bool ppm::indexPixels(const unsigned char* src)
+{
+    // Collect the distinct colors with a small open-addressed table, keyed by 0xRRGGBB
+    const unsigned int SLOTS = 1024; // Power of 2, 4x the max color count keeps probes short
+    const uint32_t EMPTY = 0xffffffff;
+    uint32_t keys[SLOTS];
+    unsigned char slotIdx[SLOTS];
+    memset(keys, 0xff, sizeof(keys));
+
+    uint32_t colors[256];
+    unsigned int numColors = 1;
+    colors[0] = 0; // Black is always local index 0, like in every Palette
+
+    vector<unsigned char> local(size);
+    uint32_t lastKey = 0;
+    unsigned char lastIdx = 0;
+    for (unsigned int i = 0; i < size; i++, src += 3)
+    {
+        const uint32_t KEY = (uint32_t) src[0] << 16 | src[1] << 8 | src[2];
+        if (KEY != lastKey) // Neighbouring pixels mostly share a color
+        {
+            unsigned int slot = (KEY * 2654435761u) >> 22; // Top 10 bits of a multiplicative hash
+            while (keys[slot] != EMPTY && keys[slot] != KEY)
+                slot = (slot + 1) & (SLOTS - 1);
+
+            if (keys[slot] == EMPTY)
+            {
+                if (KEY == 0)
+                    slotIdx[slot] = 0;
+                else
+                {
+                    if (numColors == 256)
+                        return false;
+                    colors[numColors] = KEY;
+                    slotIdx[slot] = numColors++;
+                }
+                keys[slot] = KEY;
+            }
+            lastKey = KEY;
+            lastIdx = slotIdx[slot];
         }
-    } else {
-        cerr << "Error. Unable to open " << fname << endl;
-        inp.close();
-        return false;
+        local[i] = lastIdx;
     }
 
-    // Read operation was successful
-    inp.close();
+    // Map local indices into the shared palette if everything fits, otherwise a private one.
+    // Images may be decoded on several threads at once (AssetLoader), the shared palette is guarded.
+    pthread_mutex_lock(&sharedPaletteLock);
+    Palette* pal = &Palette::shared();
+    unsigned int missing = 0;
+    for (unsigned int c = 1; c < numColors; c++)
+    {
+        if (pal->find(colors[c]) < 0)
+            missing++;
+    }
+    if (pal->count + missing > 256)
+    {
+        ownPalette = new Palette;
+        pal = ownPalette;
+    }
+
+    unsigned char remap[256];
+    remap[0] = 0;
+    for (unsigned int c = 1; c < numColors; c++)
+    {
+        int found = pal->find(colors[c]);
+        remap[c] = (found >= 0) ? found : pal->add(colors[c]);
+    }
+    pthread_mutex_unlock(&sharedPaletteLock);
+    for (unsigned int i = 0; i < size; i++)
+        local[i] = remap[local[i]];
+
+    idx.swap(local);
+    idxPix = &idx[0];
+    palette = pal;
     return true;
 }
 
 
+size_t ppm::bytes() const
+{
+    size_t total = r.capacity() + g.capacity() + b.capacity() + a.capacity() + idx.capacity();
+    total += spans.capacity()*sizeof(Span) + rowSpans.capacity()*sizeof(unsigned int);
+    total += blendSpans.capacity()*sizeof(Span) + blendRowSpans.capacity()*sizeof(unsigned int);
+    if (ownPalette != NULL)
+        total += sizeof(Palette);
+    return total;
+}
+
+
+void ppm::setAlpha(const unsigned char* alpha)
+{
+    if (alpha != NULL && (idxPix != NULL || r.empty())) // Expand indexed or borrowed pixels to owned planes
+    {
+        vector<unsigned char> red(size), green(size), blue(size);
+        for (unsigned int i = 0; i < size; i++)
+            pixel(i, red[i], green[i], blue[i]);
+        releasePixels();
+        r.swap(red);
+        g.swap(green);
+        b.swap(blue);
+    }
+
+    if (alpha != NULL)
+        a.assign(alpha, alpha + size);
+    else
+        vector<unsigned char>().swap(a);
+    bindPlanes();
+    buildSpans();
+}
+
+
+void ppm::buildRuns(const bool BLEND, vector<Span> &runs, vector<unsigned int> &rowRuns)
+{
+    runs.clear();
+    rowRuns.assign(height + 1, 0);
+
+    unsigned int i = 0; // Counter for pixel indices
+    for (unsigned int y = 0; y < height; y++)
+    {
+        rowRuns[y] = runs.size();
+        unsigned int x = 0;
+        while (x < width)
+        {
+            // Skip pixels that belong to the other list (or to neither)
+            while (x < width && (BLEND ? !blended(i) : !opaque(i))) {
+                x++;
+                i++;
+            }
+            if (x == width)
+                break;
+
+            // Measure run
+            Span s;
+            s.x = x;
+            while (x < width && (BLEND ? blended(i) : opaque(i))) {
+                x++;
+                i++;
+            }
+            s.len = x - s.x;
+            runs.push_back(s);
+        }
+    }
+    rowRuns[height] = runs.size();
+}
+
+
+void ppm::buildSpans()
+{
+    buildRuns(false, spans, rowSpans);
+    if (aPix != NULL)
+        buildRuns(true, blendSpans, blendRowSpans);
+    else
+    {
+        blendSpans.clear();
+        blendRowSpans.clear();
+    }
+}
+
+
 bool ppm::write(const string &fname) {
     std::ofstream inp(fname.c_str(), std::ios::out | std::ios::binary);
     if (inp.is_open()) {
 
-        inp << "P6\n"; // PPM format code
-        inp << width;
-        inp << " ";
-        inp << height << "\n";
-        inp << max_col_val << "\n";
+        const int DEPTH = (aPix != NULL) ? 4 : 3;
+        if (aPix != NULL) { // PAM format, the only one with alpha
+            inp << "P7\nWIDTH " << width << "\nHEIGHT " << height << "\nDEPTH 4\nMAXVAL " << max_col_val;
+            inp << "\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+        } else {
+            inp << "P6\n"; // PPM format code
+            inp << width;
+            inp << " ";
+            inp << height << "\n";
+            inp << max_col_val << "\n";
+        }
 
-        char aux;
+        unsigned char px[4];
         for (unsigned int i = 0; i < size; ++i) {
-            aux = (char) r[i];
-            inp.write(&aux, 1);
-            aux = (char) g[i];
-            inp.write(&aux, 1);
-            aux = (char) b[i];
-            inp.write(&aux, 1);
+            pixel(i, px[0], px[1], px[2]);
+            if (aPix != NULL)
+                px[3] = aPix[i];
+            inp.write((const char*) px, DEPTH);
         }
     } else {
         cerr << "Error. Unable to open " << fname << endl;
@@ -147,14 +691,100 @@ bool ppm::write(const string &fname) {
 
 void ppm::draw(Canvas* c, const int xPos, const int yPos)
 {
-	int i = 0; // Counter for vector indices
-	for (int yOff = 0; yOff < height; yOff++)
+    static const Color BLACK(0, 0, 0);
+    this->draw(c, xPos, yPos, BLACK);
+}
+
+
+void ppm::draw(Canvas* c, const int xPos, const int yPos, const Color &backdrop)
+{
+	// Visible rectangle, in image coordinates [xMin,xMax) x [yMin,yMax)
+	const int xMin = std::max(0, -xPos);
+	const int yMin = std::max(0, -yPos);
+	const int xMax = std::min((int) width, c->width() - xPos);
+	const int yMax = std::min((int) height, c->height() - yPos);
+	if (xMin >= xMax || yMin >= yMax) // Entirely off the canvas
+		return;
+
+	// Composing into a SoftCanvas, the runs are written straight into its buffer
+	SoftCanvas* soft = dynamic_cast<SoftCanvas*>(c);
+	if (soft != NULL && soft->scaled())
+		soft = NULL; // Colors have to be scaled, through SetPixel()
+
+	for (int yOff = yMin; yOff < yMax; yOff++)
 	{
-		for (int xOff = 0; xOff < width; xOff++)
+		const int Y = yPos + yOff;
+		const unsigned int ROW = yOff*width;
+		for (unsigned int k = rowSpans[yOff]; k < rowSpans[yOff+1]; k++)
 		{
-            if ( r[i]!=0 || g[i]!=0 || b[i]!=0 ) // Allow black pixels to be transparent
-			    c->SetPixel(xPos+xOff, yPos+yOff, r[i],g[i],b[i]);
-			i++;
+			// Clip the opaque run to the visible columns, then write it in one tight loop
+			const int START = std::max((int) spans[k].x, xMin);
+			const int END = std::min((int) spans[k].x + spans[k].len, xMax);
+			if (START >= END)
+				continue;
+			unsigned int i = ROW + START;
+			if (soft != NULL)
+			{
+				unsigned char* dst = soft->at(xPos + START, Y);
+				if (idxPix != NULL)
+				{
+					const Palette &pal = *palette;
+					for (int n = START; n < END; n++, i++, dst += 3)
+					{
+						dst[0] = pal.r[idxPix[i]];
+						dst[1] = pal.g[idxPix[i]];
+						dst[2] = pal.b[idxPix[i]];
+					}
+				}
+				else
+					interleaveRGB(rPix + i, gPix + i, bPix + i, dst, END - START);
+			}
+			else if (idxPix != NULL) // Look colors up through the palette
+			{
+				const Palette &pal = *palette;
+				for (int x = xPos + START; x < xPos + END; x++, i++)
+					c->SetPixel(x, Y, pal.r[idxPix[i]], pal.g[idxPix[i]], pal.b[idxPix[i]]);
+			}
+			else
+			{
+				for (int x = xPos + START; x < xPos + END; x++, i++)
+					c->SetPixel(x, Y, rPix[i], gPix[i], bPix[i]);
+			}
+		}
+	}
+
+	// Partly transparent runs (alpha images only), blended in chunks through the kernel
+	if (blendSpans.empty())
+		return;
+	const int CHUNK = 64;
+	unsigned char dr[CHUNK], dg[CHUNK], db[CHUNK];
+	for (int yOff = yMin; yOff < yMax; yOff++)
+	{
+		const int Y = yPos + yOff;
+		const unsigned int ROW = yOff*width;
+		for (unsigned int k = blendRowSpans[yOff]; k < blendRowSpans[yOff+1]; k++)
+		{
+			const int START = std::max((int) blendSpans[k].x, xMin);
+			const int END = std::min((int) blendSpans[k].x + blendSpans[k].len, xMax);
+			for (int x0 = START; x0 < END; x0 += CHUNK)
+			{
+				const int N = std::min(CHUNK, END - x0);
+				const unsigned int i = ROW + x0;
+				if (soft != NULL) // Blend over what's really underneath
+				{
+					unsigned char* dst = soft->at(xPos + x0, Y);
+					deinterleaveRGB(dst, dr, dg, db, N);
+					blendRun(rPix + i, gPix + i, bPix + i, aPix + i, dr, dg, db, N);
+					interleaveRGB(dr, dg, db, dst, N);
+					continue;
+				}
+				memset(dr, backdrop.r, N);
+				memset(dg, backdrop.g, N);
+				memset(db, backdrop.b, N);
+				blendRun(rPix + i, gPix + i, bPix + i, aPix + i, dr, dg, db, N);
+				for (int n = 0; n < N; n++)
+					c->SetPixel(xPos + x0 + n, Y, dr[n], dg[n], db[n]);
+			}
 		}
 	}
 }
@@ -179,18 +809,134 @@ void ppm::drawCenter(Canvas* c, const int xPos, const int yPos)
 }
 
 
+//==============// FRAME CACHE CLASS
+
+
+FrameCache::FrameCache(const size_t BUDGET)
+{
+    budget = BUDGET;
+    used = 0;
+    hits = misses = evictions = 0;
+    holds = 0;
+}
+
+
+FrameCache& FrameCache::shared()
+{
+    // Function static, Frames objects may be built during static initialization
+    static FrameCache cache(DEF_BUDGET);
+    return cache;
+}
+
+
+void FrameCache::setBudget(const size_t BYTES)
+{
+    budget = BYTES;
+    evict();
+}
+
+
+FrameCache::Handle FrameCache::insert(Frames* owner, const int INDEX, const size_t BYTES)
+{
+    Entry e;
+    e.owner = owner;
+    e.index = INDEX;
+    e.bytes = BYTES;
+    e.held = holds > 0;
+    lru.push_front(e);
+    used += BYTES;
+    misses++;
+
+    // Pinned while evicting, so a frame bigger than the whole budget still gets drawn once
+    const bool HELD = lru.begin()->held;
+    lru.begin()->held = true;
+    evict();
+    lru.begin()->held = HELD;
+    return lru.begin();
+}
+
+
+void FrameCache::touch(const Handle H)
+{
+    hits++;
+    if (holds > 0)
+        H->held = true;
+    if (H != lru.begin())
+        lru.splice(lru.begin(), lru, H);
+}
+
+
+void FrameCache::hold()
+{
+    holds++;
+}
+
+
+void FrameCache::release()
+{
+    if (holds == 0 || --holds > 0)
+        return;
+    for (std::list<Entry>::iterator it = lru.begin(); it != lru.end(); ++it)
+        it->held = false;
+    evict();
+}
+
+
+void FrameCache::remove(const Handle H)
+{
+    used -= H->bytes;
+    lru.erase(H);
+}
+
+
+void FrameCache::evict()
+{
+    std::list<Entry>::iterator it = lru.end();
+    while (used > budget && it != lru.begin())
+    {
+        --it;
+        if (it->held)
+            continue;
+
+        Entry e = *it;
+        used -= e.bytes;
+        it = lru.erase(it); // Next --it lands on the entry before the victim
+        evictions++;
+        e.owner->evict(e.index); // Frees the ppm
+    }
+}
+
+
+void FrameCache::printStats() const
+{
+    cerr << "Frame cache: " << lru.size() << " frames, " << used << "/" << budget << " bytes, "
+         << hits << " hits, " << misses << " loads, " << evictions << " evictions\n";
+}
+
+
 //==============// FRAMES CLASS
 
 
-Frames::Frames()
+void Frames::init()
 {
+    numFrames = 0;
+    sourceChecked = false;
+    atlas = NULL;
+    atlasViews = NULL;
+    cache = &FrameCache::shared();
+}
+
 
+Frames::Frames()
+{
+    init();
 }
 
 
 Frames::Frames(const string &FILE_PATH, const int NUM_FRAMES)
 {
-    this->load(FILE_PATH, NUM_FRAMES);
+    init();
+    this->setSource(FILE_PATH, NUM_FRAMES);
 }
 
 
@@ -200,48 +946,249 @@ Frames::~Frames()
 }
 
 
-bool Frames::load(const string &FILE_PATH, const int NUM_FRAMES)
+string Frames::atlasPath(const string &FILE_PATH)
 {
-    bool allGood = true; // All frames loaded successfully
-    unsigned int readCount = 0;
+    string base = FILE_PATH;
+    while (!base.empty() && base[base.size()-1] == '/')
+        base.erase(base.size()-1);
+    return base + ".atlas";
+}
 
-    for (int i = 0; i < NUM_FRAMES; i++)
-	{
-		string cmpFP = FILE_PATH + to_string(i) + ".ppm"; // Complete Filepath
-		ppm* img = new ppm; // Create frame
 
-        if (!img->read(cmpFP)) // Read in frame
-            allGood = false;
-        else
+void Frames::setSource(const string &FILE_PATH, const int NUM_FRAMES)
+{
+    this->unload();
+    filePath = FILE_PATH;
+    numFrames = (NUM_FRAMES > 0) ? NUM_FRAMES : 0;
+    images.assign(numFrames, (ppm*) NULL);
+    handles.assign(numFrames, FrameCache::Handle());
+    failed.assign(numFrames, false);
+    widths.assign(numFrames, 0);
+    heights.assign(numFrames, 0);
+    sourceChecked = false;
+}
+
+
+void Frames::openSource()
+{
+    if (sourceChecked)
+        return;
+    sourceChecked = true;
+
+    // Embedded bundle first (no I/O at all), then an atlas file, otherwise loose files
+    const EmbeddedAsset* e = findEmbeddedAsset(filePath);
+    if (e != NULL && openAtlas(atlasPath(filePath), e))
+        cerr << numFrames << " frames embedded for " << filePath << endl;
+    else if (openAtlas(atlasPath(filePath), NULL))
+        cerr << numFrames << " frames mapped from " << atlasPath(filePath) << endl;
+}
+
+
+bool Frames::openAtlas(const string &fname, const EmbeddedAsset* embedded)
+{
+    atlas = new Atlas;
+    bool opened = false;
+    if (embedded != NULL)
+        opened = atlas->openMemory(embedded->data, embedded->length, embedded->path);
+    else
+    {
+        struct stat st;
+        if (stat(fname.c_str(), &st) != 0) // No atlas, not an error
         {
-            readCount++;
-            images.push_back(img); // Add frame into vector
+            delete atlas;
+            atlas = NULL;
+            return false;
         }
+        opened = atlas->open(fname);
+    }
+
+    if (!opened || atlas->getNumFrames() != numFrames)
+    {
+        cerr << "Ignoring atlas for " << filePath << ", expected " << numFrames << " frames\n";
+        delete atlas;
+        atlas = NULL;
+        return false;
+    }
+
+    atlasViews = new ppm[numFrames];
+    return true;
+}
+
+
+ppm* Frames::loadFrame(const int INDEX)
+{
+    openSource();
+    return adopt(INDEX, decode(INDEX));
+}
+
+
+ppm* Frames::decode(const int INDEX)
+{
+    if (atlas != NULL) // Wrap the mapped frame, no pixel copy
+    {
+        atlas->getFrame(INDEX, atlasViews[INDEX]);
+        return &atlasViews[INDEX];
+    }
+
+    string cmpFP = filePath + to_string(INDEX) + ".ppm"; // Complete Filepath
+    ppm* img = new ppm; // Create frame
+    if (!img->read(cmpFP)) // Read in frame
+    {
+        delete img;
+        return NULL;
+    }
+    return img;
+}
+
+
+ppm* Frames::adopt(const int INDEX, ppm* img)
+{
+    if (img == NULL)
+    {
+        failed[INDEX] = true;
+        return NULL;
+    }
+    if (images[INDEX] != NULL) // Decoded twice, keep the first
+    {
+        if (img != images[INDEX])
+            delete img;
+        return images[INDEX];
+    }
+
+    images[INDEX] = img;
+    widths[INDEX] = img->width;
+    heights[INDEX] = img->height;
+    if (atlas == NULL) // Loose frames are charged to the cache, atlas frames live in the page cache
+        handles[INDEX] = cache->insert(this, INDEX, sizeof(ppm) + img->bytes());
+    return img;
+}
+
+
+void Frames::evict(const int INDEX)
+{
+    delete images[INDEX];
+    images[INDEX] = NULL;
+}
 
-	}
-	cerr << readCount <<  " frames loaded from " << FILE_PATH << endl;
 
+bool Frames::load(const string &FILE_PATH, const int NUM_FRAMES)
+{
+    this->setSource(FILE_PATH, NUM_FRAMES);
+    bool allGood = this->prefetch(0, numFrames);
+
+    unsigned int readCount = 0;
+    for (int i = 0; i < numFrames; i++)
+    {
+        if (!failed[i])
+            readCount++;
+    }
+    cerr << readCount <<  " frames loaded from " << FILE_PATH << endl;
+
+    return allGood;
+}
+
+
+bool Frames::prefetch(const int FIRST, const int COUNT)
+{
+    if (numFrames == 0)
+        return false;
+
+    bool allGood = true; // All frames loaded successfully
+    cache->hold(); // Loading the last ones mustn't evict the first
+    for (int n = 0; n < COUNT && n < numFrames; n++)
+    {
+        int i = ((FIRST + n) % numFrames + numFrames) % numFrames; // Wrap both ways
+        if (get(i) == NULL)
+            allGood = false;
+    }
+    cache->release();
     return allGood;
 }
 
 
+ppm* Frames::get(const int INDEX)
+{
+    if (INDEX < 0 || INDEX >= numFrames || failed[INDEX])
+        return NULL;
+
+    if (images[INDEX] == NULL)
+        return loadFrame(INDEX);
+
+    if (atlas == NULL)
+        cache->touch(handles[INDEX]);
+    return images[INDEX];
+}
+
+
+int Frames::getImgWidth(int i)
+{
+    if (i < 0 || i >= numFrames)
+        return 0;
+    if (widths[i] == 0) // Not loaded yet, loading it records the size
+        get(i);
+    return widths[i];
+}
+
+
+int Frames::getImgHeight(int i)
+{
+    if (i < 0 || i >= numFrames)
+        return 0;
+    if (heights[i] == 0)
+        get(i);
+    return heights[i];
+}
+
+
+bool Frames::isLoaded(const int INDEX) const
+{
+    return INDEX >= 0 && INDEX < numFrames && images[INDEX] != NULL;
+}
+
+
 void Frames::unload()
 {
-    const int SIZE = images.size();
-	for (int i = 0; i < SIZE; i++)
-	{
-		delete images[i];
-	}
-    cerr << SIZE << " frames unloaded.\n";
+    int count = 0;
+    for (int i = 0; i < (int) images.size(); i++)
+    {
+        if (images[i] == NULL)
+            continue;
+        count++;
+        if (atlas == NULL)
+        {
+            cache->remove(handles[i]);
+            delete images[i];
+        }
+        images[i] = NULL;
+    }
+
+    if (atlas != NULL) // Frames are views into one block
+    {
+        delete [] atlasViews;
+        delete atlas;
+        atlasViews = NULL;
+        atlas = NULL;
+    }
+    sourceChecked = false;
+    failed.assign(failed.size(), false);
+    widths.assign(widths.size(), 0);
+    heights.assign(heights.size(), 0);
+
+    if (count > 0)
+        cerr << count << " frames unloaded.\n";
 }
 
 
 void Frames::draw(const int INDEX, Canvas* c, const int XPOS, const int YPOS)
 {
-    images[INDEX]->draw(c, XPOS, YPOS);
+    ppm* img = get(INDEX);
+    if (img != NULL)
+        img->draw(c, XPOS, YPOS);
 }
 
 void Frames::drawCenter(const int INDEX, Canvas* c, const int XPOS, const int YPOS)
 {
-    images[INDEX]->drawCenter(c, XPOS, YPOS);
-}
\ No newline at end of file
+    ppm* img = get(INDEX);
+    if (img != NULL)
+        img->drawCenter(c, XPOS, YPOS);
+}
@@ -2,8 +2,9 @@
 	Title: ppm.h
 	Author: Garrett Carter
 	Date: 7/2/19
-	Contents:   ppm class - Process and display a binary ppm file (P6 format)
-                Frames class - Container class for ppm objects
+	Contents:   ppm class - Process and display a binary ppm file (P6 format), or a PAM file (P7, RGB or RGB_ALPHA)
+                Palette struct - Color table for palette-indexed images
+                Frames class - Container class for ppm objects, loaded from loose files or a packed atlas
 */
 
 
@@ -17,15 +18,60 @@
 #include <sstream>
 #include <exception>
 #include <cmath>
+#include <list>
 
 #include "led-matrix.h"
 #include "graphics.h"
+#include "Atlas.h"
 
 using namespace rgb_matrix; using std::string; using std::vector; using std::getline; using std::to_string;
 using std::cerr; using std::endl;
 
 
 
+// Span: A horizontal run of opaque (non-black) pixels within one row of an image
+struct Span
+{
+    uint16_t x;     // Column of the first pixel
+    uint16_t len;   // Number of pixels
+};
+
+
+//==============// PALETTE STRUCT
+// Palette: Up to 256 colors looked up by an 8-bit index. Entry 0 is always black (transparent).
+struct Palette
+{
+    unsigned char r[256];
+    unsigned char g[256];
+    unsigned char b[256];
+    unsigned int count; // Entries in use
+
+    // Palette(): Holds only black at index 0
+    Palette();
+
+    // find(): Index of the 0xRRGGBB color, -1 if not in the palette
+    int find(const uint32_t RGB) const;
+
+    // add(): Appends the 0xRRGGBB color and returns its index, -1 if the palette is full. Doesn't check for duplicates.
+    int add(const uint32_t RGB);
+
+    /*
+    shared(): Process-wide palette that indexed images use whenever their colors fit. The icons are drawn from the
+        32-color palette in weather_config.h, so every icon set ends up sharing this one table.
+    */
+    static Palette& shared();
+};
+
+
+/*
+blendRun(): Blends N source pixels over the destination planes in place, dst = (src*alpha + dst*(255 - alpha))/255
+    rounded, per channel. NEON 16 pixels per iteration when available, scalar loop otherwise.
+*/
+void blendRun(const unsigned char* srcR, const unsigned char* srcG, const unsigned char* srcB,
+              const unsigned char* alpha, unsigned char* dstR, unsigned char* dstG, unsigned char* dstB,
+              const size_t N);
+
+
 //==============// PPM CLASS
 class ppm {
 	
@@ -33,15 +79,67 @@ private:
     // init(): Initializes attributes to default values.
     void init();
 
+    // bindPlanes(): Points rPix/gPix/bPix/aPix at the owned r/g/b/a vectors
+    void bindPlanes();
+
+    // releasePixels(): Frees all pixel storage (RGB planes, alpha plane, index plane, private palette)
+    void releasePixels();
+
+    /*
+    indexPixels(): Converts the packed RGB samples (size pixels) into the index plane. Uses the shared palette if the
+        new colors fit in it, a private palette otherwise. Returns false (nothing changed) if there are more than 256 colors.
+    */
+    bool indexPixels(const unsigned char* src);
+
+    // opaque(): True if pixel i is drawn as is. Without an alpha plane black is transparent, with one only alpha 255.
+    bool opaque(const unsigned int i) const
+    {
+        if (aPix != NULL)
+            return aPix[i] == 255;
+        return (idxPix != NULL) ? idxPix[i] != 0 : (rPix[i] | gPix[i] | bPix[i]) != 0;
+    }
+
+    // blended(): True if pixel i is partly transparent and has to be blended
+    bool blended(const unsigned int i) const { return aPix != NULL && aPix[i] != 0 && aPix[i] != 255; }
+
+    // buildRuns(): Collects the runs of opaque (BLEND = false) or blended (BLEND = true) pixels, see spans
+    void buildRuns(const bool BLEND, vector<Span> &runs, vector<unsigned int> &rowRuns);
+
+    // ownPalette: Private palette of an indexed image whose colors didn't fit in Palette::shared(), else NULL
+    Palette* ownPalette;
+
+    // Not copyable, the plane pointers may point into the object itself
+    ppm(const ppm&);
+    ppm& operator=(const ppm&);
+
 public:
 
     //=============// ATTRIBUTES
 
-    // Vectors for storing the R,G,B values
+    // Vectors for storing the R,G,B values (empty when the pixels are borrowed, see wrap())
     vector<unsigned char> r;
     vector<unsigned char> g;
     vector<unsigned char> b;
 
+    // Pointers to the R,G,B planes used for drawing. These point into r/g/b, or into memory owned elsewhere.
+    // All NULL for indexed images.
+    const unsigned char* rPix;
+    const unsigned char* gPix;
+    const unsigned char* bPix;
+
+    // Alpha values, one byte per pixel (0 = transparent, 255 = opaque). Empty for images without an alpha channel.
+    vector<unsigned char> a;
+
+    // Pointer to the alpha plane used for drawing, NULL if the image has no alpha channel
+    const unsigned char* aPix;
+
+    // Palette indices, one byte per pixel. read() stores images with 256 colors or fewer this way instead of r/g/b.
+    vector<unsigned char> idx;
+
+    // idxPix, palette: Index plane and color table used for drawing. Both NULL for RGB images.
+    const unsigned char* idxPix;
+    const Palette* palette;
+
     // Height and width of the image
     unsigned int height;
     unsigned int width;
@@ -52,6 +150,18 @@ public:
     // total number of elements (pixels)
     unsigned int size;
 
+    /*
+    spans, rowSpans: Opaque runs of the image, built by buildSpans(). The runs of row y are
+        spans[rowSpans[y]] ... spans[rowSpans[y+1]-1], so draw() never visits transparent pixels.
+    */
+    vector<Span> spans;
+    vector<unsigned int> rowSpans;
+
+    // blendSpans, blendRowSpans: Runs of partly transparent pixels (alpha 1-254), same layout as spans. Empty
+    //                            without an alpha plane. Fully transparent pixels are in neither list.
+    vector<Span> blendSpans;
+    vector<unsigned int> blendRowSpans;
+
     //=============// FUNCTIONS
 
     // ppm(): Basic constructor, Calls init().
@@ -63,16 +173,80 @@ public:
     // ppm(width, height): Creates an "empty" PPM image with a given width and height; the R,G,B arrays are filled with zeros.
     ppm(const unsigned int _width, const unsigned int _height);
 
-    // read(): Read the PPM image from fname into memory. Returns false and writes to cerr upon error.
+    // ~ppm(): Frees the private palette, if any
+    ~ppm();
+
+    // isIndexed(): True if the pixels are stored as palette indices
+    bool isIndexed() const { return idxPix != NULL; }
+
+    // hasAlpha(): True if the image has an alpha plane
+    bool hasAlpha() const { return aPix != NULL; }
+
+    // pixel(): Color of pixel i (row-major), for either storage type
+    void pixel(const unsigned int i, unsigned char &red, unsigned char &green, unsigned char &blue) const
+    {
+        if (idxPix != NULL) {
+            red = palette->r[idxPix[i]]; green = palette->g[idxPix[i]]; blue = palette->b[idxPix[i]];
+        } else {
+            red = rPix[i]; green = gPix[i]; blue = bPix[i];
+        }
+    }
+
+    // bytes(): Heap memory held by the pixel data (borrowed planes and the shared palette don't count)
+    size_t bytes() const;
+
+    /*
+    read(): Read the PPM image from fname into memory. The file is pulled in with a single read() and the header
+        (magic, dimensions, 8-bit max color value, payload length) is validated before de-interleaving the pixels.
+        Images with 256 colors or fewer are stored palette-indexed (see idx), others as R,G,B planes.
+        PAM (P7) files with TUPLTYPE RGB or RGB_ALPHA are read too; RGB_ALPHA images keep R,G,B planes plus the
+        alpha plane.
+        Returns false and writes to cerr upon error; the object is left unchanged in that case.
+    */
     bool read(const string &fname);
 
-    // write(): Write the PPM image from memory into fname using ppm (P6) image format. Returns false and writes to cerr upon error.
+    /*
+    setPixels(): Replaces the image with _width x _height packed RGB samples (e.g. rendered in memory), stored the
+        same way read() stores a P6 file: palette-indexed if the colors fit, R,G,B planes otherwise.
+    */
+    void setPixels(const unsigned int _width, const unsigned int _height, const unsigned char* rgb);
+
+    /*
+    wrap(): Makes this image draw from R,G,B planes owned elsewhere (e.g. an Atlas mapping), without copying.
+        The planes must outlive the image. Any owned pixel data is released.
+    */
+    void wrap(const unsigned int _width, const unsigned int _height,
+              const unsigned char* _r, const unsigned char* _g, const unsigned char* _b);
+
+    /*
+    setAlpha(): Copies size alpha values from alpha into the alpha plane (NULL removes it) and rebuilds the spans.
+        Indexed images are expanded to R,G,B planes first.
+    */
+    void setAlpha(const unsigned char* alpha);
+
+    // buildSpans(): Rebuilds the opaque runs. Done by read() and wrap(), call it again after editing r/g/b/a by hand.
+    void buildSpans();
+
+    // write(): Write the PPM image from memory into fname using ppm (P6) image format, or PAM (P7 RGB_ALPHA) if the
+    //          image has an alpha plane. Returns false and writes to cerr upon error.
     bool write(const string &fname);
 	
 
     // draw(Canvas*, int, int): Draws the image on the canvas specified. The coordinates are the TOP-LEFT of the image
+    //                         Black pixels are transparent, only the opaque runs are written. The image is clipped
+    //                         to the canvas up front (negative coords are fine), nothing is done if it's offscreen.
+    //                         Images with an alpha plane are blended over black, see below. Into a SoftCanvas
+    //                         the runs go straight into its buffer (NEON interleaved), else through SetPixel().
 	void draw(Canvas* c, const int xPos, const int yPos);
 
+    /*
+    draw(Canvas*, int, int, Color): As above. Pixels of an alpha image with alpha 255 are written as is (black
+        included), alpha 0 is skipped, and the partly transparent runs are blended by blendRun(). A SoftCanvas is
+        read back, so they blend over the pixels underneath. Other canvases can't be, so backdrop stands in for
+        what is underneath (black after Clear()).
+    */
+    void draw(Canvas* c, const int xPos, const int yPos, const Color &backdrop);
+
     // draw(Canvas*, double, double): Rounds the doubles into ints and calls draw() with ints.
 	void draw(Canvas* c, const double xPos, const double yPos);
 
@@ -83,44 +257,192 @@ public:
 };
 
 
+//==============// FRAME CACHE CLASS
+class Frames;
+
+/*
+	FrameCache: Tracks the frames Frames objects have decoded into RAM, in least-recently-drawn order, and evicts
+		the oldest ones once their total size goes over the byte budget. Evicted frames are read back in the next
+		time they are drawn. Frames mapped from an atlas live in the page cache instead and aren't tracked here.
+*/
+class FrameCache
+{
+
+public:
+    struct Entry
+    {
+        Frames* owner;
+        int index;
+        size_t bytes;
+        bool held; // Asked for during the current hold(), not evicted until release()
+    };
+    typedef std::list<Entry>::iterator Handle;
+
+private:
+    // lru: Loaded frames, most recently used at the front
+    std::list<Entry> lru;
+    size_t budget;
+    size_t used;
+
+    // Stats
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+
+    // holds: Nesting depth of hold() calls
+    int holds;
+
+    // evict(): Drops least recently used frames until within budget, never held entries
+    void evict();
+
+
+public:
+    // FrameCache(): Empty cache with the given byte budget
+    FrameCache(const size_t BUDGET);
+
+    // shared(): The cache all Frames objects use, DEF_BUDGET until setBudget() is called
+    static FrameCache& shared();
+    static const size_t DEF_BUDGET = 256*1024;
+
+    // setBudget(): Changes the byte budget, evicting right away if the cache is now over it
+    void setBudget(const size_t BYTES);
+
+    // Getters
+    size_t getBudget() const { return budget; }
+    size_t getUsed() const { return used; }
+
+    // insert(): Adds a freshly loaded frame as most recently used, then evicts down to the budget
+    Handle insert(Frames* owner, const int INDEX, const size_t BYTES);
+
+    // touch(): Marks a cached frame as most recently used
+    void touch(const Handle H);
+
+    /*
+    hold(), release(): Frames inserted or touched between the two aren't evicted, so loading a set bigger than the
+        budget doesn't throw out its own first frames. The cache may go over budget meanwhile, release() evicts back
+        down to it. Calls nest.
+    */
+    void hold();
+    void release();
+
+    // remove(): Forgets a frame without calling back into its owner (owner is freeing it itself)
+    void remove(const Handle H);
+
+    // printStats(): Writes usage, hit and eviction counts to cerr
+    void printStats() const;
+};
+
+
 //==============// FRAMES CLASS
 class Frames
 {
+    friend class FrameCache;
+    friend class AssetLoader;
 
 private:
-    // images: Holds the pointers to DMA ppm objects held in memory
+    // filePath, numFrames: Where the frames come from, see setSource()
+    string filePath;
+    int numFrames;
+
+    // images: Holds the pointers to DMA ppm objects, NULL until a frame is first needed
     vector<ppm*> images;
+    // handles: Position of each loaded (loose file) frame in the cache
+    vector<FrameCache::Handle> handles;
+    // failed: Frames that couldn't be read, so a missing file isn't retried on every draw
+    vector<bool> failed;
+    // widths, heights: Size of each frame once it has been loaded, kept after it's evicted (0 = not known yet)
+    vector<int> widths;
+    vector<int> heights;
+
+    // sourceChecked: Set once the atlas lookup has been done for the current source
+    bool sourceChecked;
+    // atlas: Mapping the frames draw from when loaded from an atlas, NULL for loose files
+    Atlas* atlas;
+    // atlasViews: Single block of ppm objects wrapping the atlas frames (images points into it)
+    ppm* atlasViews;
+
+    // cache: Memory budget the loose frames are charged to
+    FrameCache* cache;
+
+    // init(): Empty state, no source
+    void init();
+
+    // openSource(): First time only, maps the atlas for the source if there is a usable one
+    void openSource();
+
+    // openAtlas(): Uses the embedded atlas if given, else maps the atlas at fname. Returns false if it can't be used,
+    //              e.g. missing or holding a different number of frames.
+    bool openAtlas(const string &fname, const EmbeddedAsset* embedded);
+
+    // loadFrame(): Brings frame INDEX into memory (wraps the atlas frame or reads the loose file)
+    ppm* loadFrame(const int INDEX);
+
+    /*
+    decode(): The thread-safe part of loadFrame(): reads the loose file or wraps the atlas frame, without touching
+        images or the cache. openSource() must have been called first. Returns NULL on failure.
+    */
+    ppm* decode(const int INDEX);
+
+    // adopt(): Stores a frame made by decode() (NULL = failed) as if loadFrame() had loaded it. Not thread-safe.
+    ppm* adopt(const int INDEX, ppm* img);
+
+    // evict(): Called by the cache to free a loose frame
+    void evict(const int INDEX);
 
 
 public:
     // Getters
-    int getNumFrames() { return images.size(); }
-    int getImgWidth(int i) { return images[i]->width; }
-    int getImgHeight(int i) { return images[i]->height; }
+    int getNumFrames() { return numFrames; }
+    int getImgWidth(int i);
+    int getImgHeight(int i);
 
 
     // Frames(): Empty constructor
     Frames();
 
-    // Frames(FILE_PATH, NUM_FRAMES): Calls load() using the parameters given
+    // Frames(FILE_PATH, NUM_FRAMES): Calls setSource() using the parameters given. Nothing is read until a frame is used.
     Frames(const string &FILE_PATH, const int NUM_FRAMES);
 
     // ~Frames(): Calls unload()
     ~Frames();
 
     /*
-	Function: load()
-	Purpose: Loads in ppm images referenced by the filepath (see below example) into the "images" vector.
-		Make sure the destructor gets called to release the DMA memory.
+	Function: setSource()
+	Purpose: Points the object at a set of frames without reading anything. Frames are loaded the first time they
+		are drawn (or prefetched) and kept in FrameCache::shared(), which may evict them again.
+		If an atlas with NUM_FRAMES frames is embedded in the binary for FILE_PATH (see Atlas.h), or exists on disk
+		(see atlasPath()), the frames are drawn straight from it. Otherwise the loose files are read.
 
 	Example filepath: "/images/Wonder" and numFrames = 5 will expand to:
 		"images/Wonder0", "images/Wonder1", "images/Wonder2", "images/Wonder3", "images/Wonder4"
+		or "images/Wonder.atlas" when packed
+    */
+    void setSource(const string &FILE_PATH, const int NUM_FRAMES);
+
+    /*
+    load(): Calls setSource(), then loads every frame right away. Returns false if any frame couldn't be loaded.
+        Frames past the cache budget are evicted again once loaded, least recently used (other sets') first.
     */
     bool load(const string &FILE_PATH, const int NUM_FRAMES);
 
-    // unload(): Frees the memory held by the DMA ppm images held in the "images" vector
+    /*
+    prefetch(): Loads COUNT frames starting at FIRST (wrapping around the end) so the next draws don't hit the disk,
+        e.g. prefetch(icon - 1, 3) for an icon and its neighbours. Returns false if any of them couldn't be loaded.
+    */
+    bool prefetch(const int FIRST, const int COUNT = 1);
+
+    // get(): The frame at INDEX, loaded on demand. NULL if INDEX is out of range or the frame can't be read.
+    ppm* get(const int INDEX);
+
+    // isLoaded(): True if frame INDEX is in memory right now
+    bool isLoaded(const int INDEX) const;
+
+    // unload(): Frees the memory held by the DMA ppm images held in the "images" vector, and unmaps the atlas
     void unload();
 
+    // atlasPath(): Atlas file for a frame filepath, "../img/weather/" -> "../img/weather.atlas"
+    static string atlasPath(const string &FILE_PATH);
+
     // draw(): Calls the draw() function for the appropriate ppm image held in the vector, using the parameters given
     void draw(const int INDEX, Canvas* c, const int XPOS, const int YPOS);
 
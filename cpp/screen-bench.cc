@@ -0,0 +1,202 @@
+/*
+	Title: screen-bench.cc
+	Author: Garrett Carter
+	Date: 10/17/26
+	Purpose: Render benchmark for the weather-disp screens. Builds weather-disp.cc in (SCREEN_BENCH drops its main()),
+			 loads the same fonts and icons, fills in fixed weather, verse and time fixtures, then draws every screen
+			 through the Scheduler into a SoftCanvas, no matrix needed.
+			 Each frame is timed from the Scheduler clearing the canvas to the end of the screen's draw(). The first
+			 frame of a screen (enter() and cold caches) is reported on its own, then the rest are summarized.
+			 Screens that animate are then also ticked ITERATIONS times, timing their partial update() and the share
+			 of the canvas each tick repainted.
+			 Allocations are counted through a global operator new (alloc-count.cc), so they cover the C++
+			 allocations (strings, containers) but not a bare malloc() inside libc.
+
+	Output: One JSON object per line on stdout (stderr has the progress), so runs can be diffed across commits:
+		{"bench":"screen","iterations":N,"canvas":"64x32"}
+		{"screen":"WEATHER1","frames":N,"first_us":..,"mean_us":..,"p50_us":..,"p99_us":..,"max_us":..,
+		 "allocs_per_frame":..,"bytes_per_frame":..,"tick_frames":N,"tick_mean_us":..,"tick_repaint":..}
+
+	Usage: ./screen-bench [iterations] [screen name ...]
+		Run from cpp/ like weather-disp (fonts and icons are found by relative path). Default: every screen.
+*/
+
+#define SCREEN_BENCH
+#include "weather-disp.cc"
+#include <algorithm>
+#include <cstdlib>
+
+//// DEFAULTS
+const int DEF_ITERATIONS = 5000;
+
+//// FIXTURES: What every run draws, the weather data file from a fall afternoon and Oct 17 2026 3:05:09 PM (in UTC,
+//// the benchmark sets TZ so the clock and sunrise/sunset text are the same on every machine)
+const time_t FIXTURE_TIME = 1792249509;
+const string FIXTURE_VERSE = "For God so loved the world, that he gave his only begotten Son, that whosoever believeth "
+							 "in him should not perish, but have everlasting life. John 3:16";
+
+
+//// ALLOCATION COUNTING: Every operator new in the program, read around each frame. The replacement operators
+//// are in alloc-count.cc, a separate TU from the weather-disp.cc code built in here.
+extern unsigned long allocCount;
+extern unsigned long allocBytes;
+
+
+//// FUNCTION PROTOTYPES
+
+// loadFixtures(): Fills wd with the fixture weather and lays out the fixture verse, as after the python scripts ran
+static void loadFixtures();
+// percentile(): Value at fraction P of sorted (nearest rank)
+static double percentile(const vector<double> &sorted, const double P);
+// benchScreen(): Draws screen ID ITERATIONS times and writes its line of results
+static void benchScreen(const int ID, const string &NAME, const int ITERATIONS, Canvas* c);
+
+
+int main(int argc, char** argv)
+{
+	int iterations = (argc > 1) ? atoi(argv[1]) : DEF_ITERATIONS;
+	if (iterations < 2)
+		iterations = 2;
+
+	setenv("TZ", "UTC", 1);
+	tzset();
+
+	// Same startup as weather-disp, minus the matrix, input, reactor and config file
+	loadFonts();
+	registerScreens();
+	TextCache::shared().setBudget(TEXT_CACHE_BYTES);
+	verseLayout.setPacing(LAYOUT_HOLD_SEC, LAYOUT_PX_PER_SEC);
+	verseLayout.setEffect(TEXT_SHADOW);
+	summaryLayout.setPacing(LAYOUT_HOLD_SEC, LAYOUT_PX_PER_SEC);
+	FrameCache::shared().setBudget(FRAME_CACHE_BYTES);
+	loadAssets();
+	setDefaultConfig();
+	loadFixtures();
+	prefetchIcons();
+
+	SoftCanvas canvas(M_WIDTH, M_HEIGHT);
+
+	// Every screen, in screen number order
+	const int IDS[] = {WEATHER1, WEATHER2, WEATHER3, WEATHER4, A_CLOCK, VOTD, SETTINGS_ENTER, BLANK, SETTINGS,
+					   BRIGHT_CHANGE, SHUTDOWN};
+	const char* NAMES[] = {"WEATHER1", "WEATHER2", "WEATHER3", "WEATHER4", "A_CLOCK", "VOTD", "SETTINGS_ENTER",
+						   "BLANK", "SETTINGS", "BRIGHT_CHANGE", "SHUTDOWN"};
+	const int NUM_SCREENS = sizeof(IDS)/sizeof(IDS[0]);
+
+	printf("{\"bench\":\"screen\",\"iterations\":%d,\"canvas\":\"%dx%d\"}\n", iterations, M_WIDTH, M_HEIGHT);
+	for (int i = 0; i < NUM_SCREENS; i++)
+	{
+		bool wanted = (argc <= 2);
+		for (int a = 2; a < argc; a++)
+			if (strcmp(argv[a], NAMES[i]) == 0)
+				wanted = true;
+		if (wanted)
+			benchScreen(IDS[i], NAMES[i], iterations, &canvas);
+	}
+
+	TextCache::shared().printStats(iterations);
+	return 0;
+}
+
+
+static void loadFixtures()
+{
+	WeatherData &w = *wd;
+	w.currSummary = "Partly cloudy throughout the day with light winds";
+	w.temp = 72;
+	w.apparentTemp = 70;
+	w.iconMap = 3;
+	w.weekSummary = "Light rain on Saturday, with high temperatures peaking at 88°F on Tuesday.";
+	w.todaySummary = "Mostly cloudy until evening.";
+	w.sunrise = FIXTURE_TIME - 30909;	// 6:30:00 AM
+	w.sunset = FIXTURE_TIME + 10191;	// 5:55:00 PM
+	w.moonPhaseIcon = 33;
+	w.precipProb = 20;
+	w.precipType = "rain";
+	w.high = 81;
+	w.low = 60;
+	w.humidity = 55;
+	w.uvIndex = 4;
+	w.cloudCover = 40;
+	w.windGust = 12.5;
+	w.windBearing = 220;
+	w.windDir = "SW";
+	w.visibility = 9.9;
+	w.ozone = 301.2;
+	w.pressure = 1013.25;
+	w.moonPhase = 64;
+	w.dewPoint = 58.2;
+	w.lastUpdated = FIXTURE_TIME - 600;
+	formatWeather();
+
+	verse = FIXTURE_VERSE;
+	verseLayout.layout(verse);
+
+	testTime = FIXTURE_TIME;
+}
+
+
+static double percentile(const vector<double> &sorted, const double P)
+{
+	size_t rank = (size_t) ceil(P*sorted.size());
+	if (rank < 1)
+		rank = 1;
+	return sorted[rank - 1];
+}
+
+
+static void benchScreen(const int ID, const string &NAME, const int ITERATIONS, Canvas* c)
+{
+	fprintf(stderr, "%s: %d frames\n", NAME.c_str(), ITERATIONS);
+	scheduler.show(ID);
+
+	vector<double> times;
+	times.reserve(ITERATIONS);
+	double first = 0;
+	unsigned long allocs = 0, bytes = 0;
+	for (int i = 0; i < ITERATIONS; i++)
+	{
+		scheduler.invalidate();
+		const unsigned long ALLOCS = allocCount, BYTES = allocBytes;
+		const double START = AssetLoader::nowUsec();
+		scheduler.render(c, damage);
+		const double T = AssetLoader::nowUsec() - START;
+		if (i == 0) // enter() and cold caches
+		{
+			first = T;
+			continue;
+		}
+		times.push_back(T);
+		allocs += allocCount - ALLOCS;
+		bytes += allocBytes - BYTES;
+	}
+
+	const int N = times.size();
+	double sum = 0;
+	for (int i = 0; i < N; i++)
+		sum += times[i];
+	std::sort(times.begin(), times.end());
+
+	// Ticks, as the clock and frame timers deliver them, drawn by update() where the screen has one
+	int ticks = 0;
+	double tickSum = 0, repainted = 0;
+	if (scheduler.cadence() >= Screen::PER_SECOND)
+	{
+		for (int i = 0; i < ITERATIONS; i++)
+		{
+			scheduler.tick();
+			const double START = AssetLoader::nowUsec();
+			scheduler.render(c, damage);
+			tickSum += AssetLoader::nowUsec() - START;
+			repainted += (double) damage.area()/(c->width()*c->height());
+			ticks++;
+		}
+	}
+
+	printf("{\"screen\":\"%s\",\"frames\":%d,\"first_us\":%.2f,\"mean_us\":%.2f,\"p50_us\":%.2f,\"p99_us\":%.2f,"
+		   "\"max_us\":%.2f,\"allocs_per_frame\":%.3f,\"bytes_per_frame\":%.1f,\"tick_frames\":%d,\"tick_mean_us\":%.2f,"
+		   "\"tick_repaint\":%.3f}\n",
+		   NAME.c_str(), N, first, sum/N, percentile(times, 0.5), percentile(times, 0.99), times[N - 1],
+		   (double) allocs/N, (double) bytes/N, ticks, ticks ? tickSum/ticks : 0.0, ticks ? repainted/ticks : 0.0);
+	fflush(stdout);
+}
@@ -13,17 +13,55 @@
 //// MAIN FUNCTION
 ////*********************************************************************
 
+// screen-bench.cc includes this file for the screens and helpers, with its own main()
+#ifndef SCREEN_BENCH
 int main(int argc, char** argv)
 {
-	// SIGNAL HANDLERS
-	signal(SIGTERM, killHandler);
-	signal(SIGINT, killHandler);
-	signal(SIGUSR1, InputWaker); // Handle wakeup signal from InputThread
-	signal(SIGRTMIN, PyHandler);
-	signal(SIGRTMIN+1, PyHandler);
+	startUsec = AssetLoader::nowUsec();
+
+	// Command line
+	bool daemonize = false;
+	bool headless = false;
+	string dumpDir;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-d") == 0) // Daemon flag
+			daemonize = true;
+		else if (strcmp(argv[i], "-s") == 0) // Software canvas, no panel or GPIO needed
+			headless = true;
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) // Dump shown frames as PPMs (implies -s)
+		{
+			headless = true;
+			dumpDir = argv[++i];
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [-d] [-s] [-o <frame dump dir>]\n"
+							"  -d  Run as a daemon\n"
+							"  -s  Render to a software canvas in memory instead of the panel (no input)\n"
+							"  -o  Software canvas, writing every shown frame to <dir>/frame-NNNNNN.ppm\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// SIGNALS: Blocked before the matrix and input threads start (they inherit the mask), then read from the reactor
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGRTMIN);   // Verse data from python
+	sigaddset(&signals, SIGRTMIN+1); // Weather data from python
+	Reactor::blockSignals(signals);
 
 	//=====// INITIALIZATION
 	loadFonts();
+	registerScreens();
+	TextCache::shared().setBudget(TEXT_CACHE_BYTES);
+	verseLayout.setPacing(LAYOUT_HOLD_SEC, LAYOUT_PX_PER_SEC);
+	verseLayout.setEffect(TEXT_SHADOW);
+	summaryLayout.setPacing(LAYOUT_HOLD_SEC, LAYOUT_PX_PER_SEC);
+	FrameCache::shared().setBudget(FRAME_CACHE_BYTES);
+	loadAssets();
 	// Settings
 	setDefaultConfig();
 	if (!readConfig())
@@ -31,7 +69,7 @@ int main(int argc, char** argv)
 	printConfig();
 	
 	
-	// Create Matrix Object
+	// Create Display (Matrix Object, or a software canvas)
 	RGBMatrix::Options defaults;
 	RuntimeOptions rtOps;
 	
@@ -43,20 +81,41 @@ int main(int argc, char** argv)
 		defaults.brightness = defSett["brightness"];
 	
 	rtOps.drop_privileges = 0; // Don't drop root (for shutdown command later)
-	if (argc > 1 && strcmp(argv[1], "-d") == 0) // Daemon flag
+	if (daemonize)
 	{
 		rtOps.daemon = 1; // Daemonize
 	}
 	
-	matrix = rgb_matrix::CreateMatrixFromOptions(defaults, rtOps);
-	if (matrix == NULL)
+	if (headless)
 	{
-		cerr << "Error creating matrix obj\n";
-		return 1;
+		display = new SoftDisplay(M_WIDTH, M_HEIGHT, dumpDir);
+		display->setBrightness(defaults.brightness);
+		if (daemonize && daemon(1, 0) != 0)
+			perror("daemon");
+	}
+	else
+	{
+		RGBMatrix* matrix = rgb_matrix::CreateMatrixFromOptions(defaults, rtOps);
+		if (matrix == NULL)
+		{
+			cerr << "Error creating matrix obj\n";
+			return 1;
+		}
+		display = new MatrixDisplay(matrix);
 	}
 	
-	// Start input thread
-	Input = new RotInput(pthread_self(),CLK_PIN, DT_PIN, SW_PIN, matrix, PWR_SW_PIN);
+	// Event sources (after daemonize, the reactor's fds belong to this process)
+	reactor = new Reactor;
+	frameTimer = reactor->addTimer("frame", onFrame, NULL);
+	clockTimer = reactor->addTimer("clock", onFrame, NULL, CLOCK_REALTIME);
+	brightTimer = reactor->addTimer("brightness", onBrightness, NULL);
+	configTimer = reactor->addTimer("config", onConfigFlush, NULL);
+	inputEvent = reactor->addEvent("input", onInput, NULL);
+	reactor->addSignals("signals", signals, onSignal, NULL);
+
+	// Start input thread, waking the reactor on each event (the encoder is read through the panel's GPIO)
+	if (display->matrix() != NULL)
+		Input = new RotInput(pthread_self(),CLK_PIN, DT_PIN, SW_PIN, display->matrix(), PWR_SW_PIN, inputEvent);
 	
 	// Write PID to file (after daemonize)
 	std::ofstream outFile(PID_FILE.c_str());
@@ -70,37 +129,57 @@ int main(int argc, char** argv)
 	
 	// Read in WEATHER_FILE and VERSE_FILE (existence checks are done)
 	wd->readFromFile(WEATHER_FILE);
+	formatWeather();
 	readVerse();
+	prefetchIcons();
 	
 	// Buffering Canvas
-	offscreen = matrix->CreateFrameCanvas();
+	offscreen = display->offscreen();
 
 	
 	//=====// MAIN LOOP
+	// Every pass starts from reactor events: frame timers while the screen animates, input wakeups, data signals from
+	// the python scripts, brightness samples and config flushes. A static screen blocks in runOnce() until one arrives.
+	Reactor::notify(inputEvent); // First pass draws the starting screen
 	while(!killSigReceived)
 	{
-		autoBrightness();
-		inputLoop();
-		drawLoop();
+		reactor->runOnce();
 
+		inputLoop();
 		updateWeather();
 		updateVerse();
+		autoBrightness();
+		drawLoop();
+		scheduleFrames();
+
+		if (!firstFrameShown && framesDrawn > 0)
+		{
+			firstFrameShown = true;
+			fprintf(stderr, "First frame after %.1f ms\n", (AssetLoader::nowUsec() - startUsec)/1e3);
+		}
 		
 		if (currSett["screen"] == SHUTDOWN && defSett["screen"] != SHUTDOWN && !screenChange)
 			system("sudo shutdown -h now");
 
-		writeConfig();
+		scheduleTimers();
 	}
 	
 	runWriteConfig = true;
 	writeConfig();
 	delete Input; // Cancel Input thread
 	// Do this after cancelling any threads
-	matrix->Clear();
-	delete matrix;
+	display->clear();
+	display->printStats();
+	delete display;
 	delete wd;
+	delete wt;
 
 	// Cleanup anims and icons
+	FrameCache::shared().printStats();
+	TextCache::shared().printStats(framesDrawn);
+	scheduler.printStats();
+	reactor->printStats();
+	delete reactor;
 	delete weatherIcons;
 	delete ifaceIcons;
 	
@@ -108,6 +187,352 @@ int main(int argc, char** argv)
 	fprintf(stderr,"\nBye! :)\n");
 	return 0;
 }
+#endif // SCREEN_BENCH
+
+
+////*********************************************************************
+//// SCREENS
+////*********************************************************************
+
+// Each screen draws onto a canvas the Scheduler has cleared, and says how often it has to be drawn again. Animated
+// screens also update() just the part that moves on a tick.
+
+class Weather1Screen : public Screen
+{
+	int summaryLane; // For scrolling text
+	bool scrolling;
+public:
+	Weather1Screen() : Screen("WEATHER1"), summaryLane(0), scrolling(false) {}
+	void enter()
+	{
+		scroller.clear();
+		summaryLane = scroller.addLane(f_5x7, 26 + round(f_5x7.height()/2.0), white, SCROLL_PX_PER_SEC);
+		scroller.setEffect(summaryLane, TEXT_SHADOW);
+	}
+	void draw(Canvas* c)
+	{
+		// Draw Weather Icon
+		weatherIcons->drawCenter(wd->iconMap, c, 11, 8);
+
+		// Draw Text
+		DrawTextByCenter(c,  f_5x7,	 42,  3,	orange,    NULL, 	wt->highAndLow);
+		DrawTextByCenter(c,	 f_5x7,	 31, 10,    skyBlue,   NULL, 	wt->precipChance);
+		DrawTextByCenter(c,  f_5x7,  53, 10, 	limeGreen, NULL, 	wt->currTemp);
+		DrawTextByCenter(c,  f_5x7,	 53, 17,	brightRed, NULL, 	wt->appTemp);
+
+		// Decide to scroll or fix in place the current conditions summary text
+		scrolling = getTotalWidth(f_5x7, wt->currSummary) > M_WIDTH - 6;
+		if (scrolling) // Too big, need to scroll
+		{
+			scroller.setText(summaryLane, wt->currSummary);
+			scroller.draw(c, summaryLane);
+		}
+		else // Text can fit comfortably
+		{
+			DrawTextByCenter(c, f_5x7, 31,  26, white, NULL, wt->currSummary, 0);
+			scroller.restart(summaryLane); // Start offscreen if it gets too big
+		}
+	}
+	// While scrolling, only the summary lane moves
+	bool update(Canvas* c, Damage &damage)
+	{
+		if (!scrolling)
+			return false;
+		const Rect LANE = scroller.bounds(summaryLane, M_WIDTH);
+		clearRect(c, LANE);
+		damage.add(LANE);
+		scroller.draw(c, summaryLane);
+		return true;
+	}
+	Cadence cadence() const { return scrolling ? PER_FRAME : ON_DATA; }
+};
+
+
+class Weather2Screen : public Screen
+{
+public:
+	Weather2Screen() : Screen("WEATHER2") {}
+	void enter() { summaryLayout.restart(); } // Start from today's summary
+	void draw(Canvas* c)
+	{
+		summaryLayout.draw(c, white);
+		weatherIcons->drawCenter(wd->moonPhaseIcon, c, 10, 13);
+		DrawTextByCenter(c, f_4x6, 39,  9, pureYellow, NULL, wt->sunrise);
+		DrawTextByCenter(c, f_4x6, 39, 15, orange	 , NULL, wt->sunset);
+		DrawTextByCenter(c, f_4x6, 39, 21, skyBlue	 , NULL, wt->moon);
+		DrawTextByCenter(c, f_4x6, 39, 27, brightRed , NULL, wt->uvIndex);
+	}
+	// Only the summary line pages, redrawn with the top of the moon icon it sits on
+	bool update(Canvas* c, Damage &damage)
+	{
+		const Rect WINDOW = summaryLayout.bounds();
+		clearRect(c, WINDOW);
+		damage.add(WINDOW);
+		summaryLayout.draw(c, white);
+		ClipCanvas clip(c, WINDOW);
+		weatherIcons->drawCenter(wd->moonPhaseIcon, &clip, 10, 13);
+		return true;
+	}
+	// Paging through the summaries when they don't fit
+	Cadence cadence() const { return summaryLayout.animated() ? PER_FRAME : ON_DATA; }
+};
+
+
+class Weather3Screen : public Screen
+{
+public:
+	Weather3Screen() : Screen("WEATHER3") {}
+	void draw(Canvas* c)
+	{
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2,  2, skyBlue, NULL,   wt->humidity);
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2,  8, orange	 , NULL,  wt->visibility);
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2, 14, pureGreen	 , NULL,  wt->wind);
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2, 20, brightRed , NULL,   wt->direction);
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2, 26, pureYellow , NULL,   wt->updated);
+	}
+	Cadence cadence() const { return ON_DATA; }
+};
+
+
+class Weather4Screen : public Screen
+{
+public:
+	Weather4Screen() : Screen("WEATHER4") {}
+	void draw(Canvas* c)
+	{
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2,  2, skyBlue , NULL,   wt->cloudCover);
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2,  8, pureGreen	 , NULL,  wt->dewPoint);
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2, 14, orange	 , NULL,  wt->pressure);
+		DrawTextByCenter(c, f_4x6, M_WIDTH/2, 20, purple, NULL,   wt->ozone);
+	}
+	Cadence cadence() const { return ON_DATA; }
+};
+
+
+class ClockScreen : public Screen
+{
+	char dayText		[10];
+	char dateText		[10];
+	char yearText		[10];
+	char timeTextLine1	[15];
+	char timeTextLine2	 [5];
+	struct tm timeStruct;
+	int shownHour; // Of the last frame, everything but the hands and time line stays put within the hour
+
+	static const int cX = M_WIDTH/2 - 16;
+	static const int cY = M_HEIGHT/2 - 1;
+	static const int r = M_HEIGHT/2 - 1;
+
+	// readTime(): Fills in the time and its text
+	void readTime()
+	{
+		// Drawn on the clock timer, just past each second tick of the system clock. Read with clock_gettime(), time()
+		// can come from the coarse clock and still be on the previous second right at the tick.
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		time_t now = (testTime != 0) ? testTime : ts.tv_sec;
+		//now = 1565001008; // Bogus morning Test Time
+		//now = 1565047808; // evening
+
+		// Process Time
+		localtime_r(&now, &timeStruct);
+		strftime(dayText, 10, 		"%a",		 	&timeStruct);
+		strftime(dateText, 10, 		"%b %-d",		&timeStruct);
+		strftime(yearText, 10, 		"%Y", 		 	&timeStruct);
+		if (currSett["24hrMode"])
+		{
+			strftime(timeTextLine1, 15, "%H:%M:%S", 	&timeStruct);
+			strftime(timeTextLine2, 5, 	"", 			&timeStruct);
+		}
+		else // 12hr Mode
+		{
+			strftime(timeTextLine1, 15, "%-I:%M:%S", 	&timeStruct);
+			strftime(timeTextLine2, 5, 	"%p", 			&timeStruct);
+		}
+	}
+
+	void drawClock(Canvas* c)
+	{
+		Color cir = darkBlue;
+		Color hr = orange;
+		Color min = purple;
+		Color sec = darkBlue;
+		DrawAnalogClock(c,cX,cY,r,cir,hr,min,sec,&timeStruct);
+	}
+
+	void drawTimeLine(Canvas* c)
+	{
+		DrawTextByCenter(c, f_4x6, 47, 21, purple, NULL, 	timeTextLine1);
+	}
+
+public:
+	ClockScreen() : Screen("A_CLOCK"), shownHour(-1) {}
+	void draw(Canvas* c)
+	{
+		readTime();
+		shownHour = timeStruct.tm_hour;
+
+		//=====// Drawing
+		drawClock(c);
+		DrawTextByCenter(c, f_4x6, 47,  3, purple, NULL, 	dayText);
+		DrawTextByCenter(c, f_4x6, 47,  9, darkBlue, NULL,	dateText);
+		DrawTextByCenter(c, f_4x6, 47, 15, orange, NULL, 	yearText);
+		drawTimeLine(c);
+		DrawTextByCenter(c, f_4x6, 47, 27, purple, NULL, 	timeTextLine2);
+	}
+	// Each second only the analog clock (left half) and the time line change
+	bool update(Canvas* c, Damage &damage)
+	{
+		readTime();
+		if (timeStruct.tm_hour != shownHour) // New hour (maybe a new day, or AM/PM)
+			return false;
+
+		const Rect CLOCK(0, 0, M_WIDTH/2, M_HEIGHT);
+		const Rect TIME_LINE(M_WIDTH/2, 21 + round(f_4x6.height()/2.0) - f_4x6.baseline(), M_WIDTH/2, f_4x6.height());
+		clearRect(c, CLOCK);
+		clearRect(c, TIME_LINE);
+		damage.add(CLOCK);
+		damage.add(TIME_LINE);
+
+		ClipCanvas clockClip(c, CLOCK), timeClip(c, TIME_LINE);
+		drawClock(&clockClip);
+		drawTimeLine(&timeClip);
+		return true;
+	}
+	Cadence cadence() const { return PER_SECOND; }
+};
+
+
+class VerseScreen : public Screen
+{
+public:
+	VerseScreen() : Screen("VOTD") {}
+	void enter() { verseLayout.restart(); } // Start from the top of the verse
+	void draw(Canvas* c)
+	{
+		DrawTextCentered(c,f_4x6, 5,orange,NULL,VOTD_TITLE);
+		verseLayout.draw(c, pureGreen);
+	}
+	// The title stays put, only the verse window moves
+	bool update(Canvas* c, Damage &damage)
+	{
+		clearRect(c, verseLayout.bounds());
+		damage.add(verseLayout.bounds());
+		verseLayout.draw(c, pureGreen);
+		return true;
+	}
+	// Scrolling through the verse when it doesn't fit
+	Cadence cadence() const { return verseLayout.animated() ? PER_FRAME : ON_DATA; }
+};
+
+
+class SettingsEnterScreen : public Screen
+{
+public:
+	SettingsEnterScreen() : Screen("SETTINGS_ENTER") {}
+	void draw(Canvas* c)
+	{
+		DrawTextByCenter(c, f_5x7, 41, f_5x7.baseline()-2, brightRed, NULL, "Enter",0);
+		DrawTextByCenter(c, f_5x7, 41, 2*f_5x7.baseline()-1, brightRed, NULL, "Settings",0);
+		ifaceIcons->drawCenter(0, c, 11, 8);
+	}
+	Cadence cadence() const { return STATIC; }
+};
+
+
+class BlankScreen : public Screen
+{
+public:
+	BlankScreen() : Screen("BLANK") {}
+	void draw(Canvas*) {}
+	Cadence cadence() const { return STATIC; }
+};
+
+
+class SettingsScreen : public Screen
+{
+public:
+	SettingsScreen() : Screen("SETTINGS") {}
+	void draw(Canvas* c)
+	{
+		vector<string> options(settingSelections);
+		
+		const Color ARROW_COLOR = orange;
+		const Color TEXT_COLOR = darkBlue;
+		
+		// Dynamic Brightness Text
+		if (currSett["autoBrightness"])
+			options[0].append("ON");
+		else
+			options[0].append("OFF");
+
+		const int vertSpacing = 1;
+		const int fromTop = 5;
+
+		int y;
+		uint8_t numOptions = options.size();
+		for (size_t i = 0; i < numOptions; i++) // Draw each option and selection arrow
+		{
+			int* xBound;
+
+			y = fromTop + i*(f_4x6.baseline() + vertSpacing);
+			xBound = DrawTextCentered(c,f_4x6,y,TEXT_COLOR,NULL, options[i],0);
+
+			if (i == currSett["selection"]) // Draw Selection Arrows
+			{
+				int x1 = xBound[0] - FontMetrics::of(f_4x6).advance('>');
+				TextCache::shared().draw(c,f_4x6,x1,y,ARROW_COLOR,NULL,">");
+				TextCache::shared().draw(c,f_4x6,xBound[1]+1,y,ARROW_COLOR,NULL,"<");
+			}
+		}
+	}
+	Cadence cadence() const { return STATIC; }
+};
+
+
+class BrightChangeScreen : public Screen
+{
+public:
+	BrightChangeScreen() : Screen("BRIGHT_CHANGE") {}
+	void draw(Canvas* c)
+	{
+		int b = currSett["brightness"];
+		string bText = "ManBrt=";
+		DrawTextCentered(c,f_4x6,f_4x6.baseline(),darkBlue,NULL,bText);
+		DrawTextCentered(c,f_4x6,2*f_4x6.baseline()+1,orange,NULL,to_string(b));
+	}
+	Cadence cadence() const { return STATIC; }
+};
+
+
+class ShutdownScreen : public Screen
+{
+public:
+	ShutdownScreen() : Screen("SHUTDOWN") {}
+	void draw(Canvas* c)
+	{
+		weatherIcons->drawCenter(26, c, 11, 8);
+		DrawTextCentJust(c, f_5x7, 41, f_5x7.baseline()+1,   blue, NULL, "Powering");
+		DrawTextCentJust(c, f_5x7, 42, 2*f_5x7.baseline()+1, blue, NULL, "down");
+	}
+	Cadence cadence() const { return STATIC; }
+};
+
+
+void registerScreens()
+{
+	scheduler.add(WEATHER1, new Weather1Screen);
+	scheduler.add(WEATHER2, new Weather2Screen);
+	scheduler.add(WEATHER3, new Weather3Screen);
+	scheduler.add(WEATHER4, new Weather4Screen);
+	scheduler.add(A_CLOCK, new ClockScreen);
+	scheduler.add(VOTD, new VerseScreen);
+	scheduler.add(SETTINGS_ENTER, new SettingsEnterScreen);
+	scheduler.add(BLANK, new BlankScreen);
+	scheduler.add(SETTINGS, new SettingsScreen);
+	scheduler.add(BRIGHT_CHANGE, new BrightChangeScreen);
+	scheduler.add(SHUTDOWN, new ShutdownScreen);
+}
 
 
 ////*********************************************************************
@@ -117,8 +542,11 @@ int main(int argc, char** argv)
 void inputLoop()
 {		
 	// Locals
-	RGBMatrix* m = matrix;
-	FrameCanvas* c = offscreen;
+	if (Input == NULL) // Headless
+	{
+		inputReceived = false;
+		return;
+	}
 
 	switch (Input->getEvent())
 	{
@@ -132,7 +560,7 @@ void inputLoop()
 				b += 1;
 			
 			if (!currSett["autoBrightness"])
-				m->SetBrightness(b);
+				display->setBrightness(b);
 			currSett["brightness"] = b;
 			refreshScreen = true;
 			break;
@@ -173,7 +601,7 @@ void inputLoop()
 				b -= 1;
 
 			if (!currSett["autoBrightness"])
-				m->SetBrightness(b);
+				display->setBrightness(b);
 			currSett["brightness"] = b;
 			refreshScreen = true;
 			break;
@@ -220,7 +648,7 @@ void inputLoop()
 				if (currSett["autoBrightness"])
 				{
 					currSett["autoBrightness"] = 0;
-					matrix->SetBrightness(currSett["brightness"]);
+					display->setBrightness(currSett["brightness"]);
 				}
 				else
 				{
@@ -258,6 +686,7 @@ void inputLoop()
 		{
 			currSett["24hrMode"] = !currSett["24hrMode"];
 			runWriteConfig = true;
+			refreshScreen = true;
 			break;
 		}
 
@@ -281,403 +710,18 @@ void inputLoop()
 
 void drawLoop()
 {
-	if (!refreshScreen)
-		return;
+	if (screenChange)
+		scheduler.show(currSett["screen"]);
+	if (refreshScreen) // Input or brightness change, draw regardless of the screen's cadence
+		scheduler.invalidate();
 	refreshScreen = false;
-	// flushBuffAtEnd: Flag used to indicate if buffering should be handled at end of drawLoop()
-	bool flushBuffAtEnd = true;
 
-	
-	switch(currSett["screen"]) // Draw appropriate data
+	if (scheduler.render(offscreen, damage))
 	{
-
-
-	case WEATHER1:
-	{
-		// Vars
-		static int xPos; // For scrolling text
-		bool isScrolling = false;
-		if (screenChange)
-		{
-			screenChange = 0;
-			xPos = M_WIDTH; // Start offscreen
-		}
-
-		offscreen->Clear();
-
-		// Construct Strings
-		string highAndLow = 	to_string(wd->high) + "F/" + to_string(wd->low) + "F";
-		string precipChance = 	to_string(wd->precipProb) + "%";
-		string currTemp = 		to_string(wd->temp) + "F";
-		string appTemp = 		to_string(wd->apparentTemp) + "F";
-		
-		
-		// Draw Weather Icon
-		weatherIcons->drawCenter(wd->iconMap, offscreen, 11, 8);
-
-		// Draw Text
-		DrawTextByCenter(offscreen,  f_5x7,	 42,  3,	orange,    NULL, 	highAndLow);
-		DrawTextByCenter(offscreen,	 f_5x7,	 31, 10,    skyBlue,   NULL, 	precipChance);
-		DrawTextByCenter(offscreen,  f_5x7,  53, 10, 	limeGreen, NULL, 	currTemp);
-		DrawTextByCenter(offscreen,  f_5x7,	 53, 17,	brightRed, NULL, 	appTemp);
-		
-
-		// Decide to scroll or fix in place the current conditions summary text
-		if (getTotalWidth(f_5x7, wd->currSummary) > M_WIDTH - 6) // Too big, need to scroll
-		{
-			scrollTextAtCenter(xPos,offscreen,f_5x7,26,white,NULL,wd->currSummary.c_str());
-			isScrolling = true;
-		}
-		else // Text can fit comfortably
-		{
-			DrawTextByCenter(offscreen, f_5x7, 31,  26, white, NULL, wd->currSummary.c_str(), 0);
-		}
-
-
-		offscreen = matrix->SwapOnVSync(offscreen, 1);
-		flushBuffAtEnd = false;
-		refreshScreen = true; // Loop Continuously
-
-		if (isScrolling)
-			usleep(SCROLL_DELAY_USEC);
-		else
-			usleep(0.5e6); // Reasonable update delay
-
+		offscreen = display->swap(&damage);
+		framesDrawn++;
+		screenChange = false;
 	}
-		break;
-
-
-	case WEATHER2:
-	{
-		// Var declaration
-		static int x1;
-
-		if (screenChange) // Flag indicates first loop upon transition to this screen, reset at end of main
-		{
-			// Init positions for scrolling texts
-			x1 = M_WIDTH;
-			screenChange = 0;
-		}
-
-		offscreen->Clear();
-
-		//====// Format Data
-		char sunriseText	[15] = 	"";
-		char sunsetText		[15] = 	"";
-		
-		// Sunrise/Sunset
-		struct tm* 	tmStruct = localtime(&(wd->sunrise));
-		strftime(sunriseText, 15, 	"SR-%-I:%M%p", tmStruct);
-					tmStruct = localtime(&(wd->sunset));
-		strftime(sunsetText, 15, 	"SS-%-I:%M%p", tmStruct);
-
-		// Moon Phase
-		string moonText = "MN-" + to_string(wd->moonPhase) + "%";
-		// uv Index
-		string uvIndexText = "UV-" + to_string(wd->uvIndex);
-
-		string phraseText = wd->todaySummary + " //  " + wd->weekSummary;
-
-
-		//====// Draw data
-		scrollTextAtCenter(x1,offscreen,f_4x6, 2,white,NULL,phraseText);
-		weatherIcons->drawCenter(wd->moonPhaseIcon, offscreen, 10, 13);
-		DrawTextByCenter(offscreen, f_4x6, 39,  9, pureYellow, NULL, sunriseText);
-		DrawTextByCenter(offscreen, f_4x6, 39, 15, orange	 , NULL, sunsetText);
-		DrawTextByCenter(offscreen, f_4x6, 39, 21, skyBlue	 , NULL, moonText);
-		DrawTextByCenter(offscreen, f_4x6, 39, 27, brightRed , NULL, uvIndexText);
-		
-
-
-		/* Handle swapping here inside this loop, for this particular state 
-		   (To give instant response for state switching) */
-		offscreen = matrix->SwapOnVSync(offscreen, 1);
-		flushBuffAtEnd = false;
-		refreshScreen = true;
-		usleep(SCROLL_DELAY_USEC);
-
-	}
-		break;
-
-
-	case WEATHER3:
-	{
-		offscreen->Clear();
-
-		if (screenChange)
-		{
-			screenChange = 0;
-		}
-
-		//====// Format Data
-		char humidityText	[20] = 	"";
-		char visibilityText	[20] = 	"";
-		char windText		[20] = 	"";
-		char directionText	[20] = 	"";
-		char updatedText	[20] = 	"";
-
-		sprintf(humidityText, 		"HUM-%d%%", wd->humidity);
-		sprintf(visibilityText, 	"VIS-%.1f mi", wd->visibility);
-		sprintf(windText, 			"WND-%.1f mph", wd->windGust);
-		sprintf(directionText,  	"DIR-%d°-%s", wd->windBearing, wd->windDir.c_str()); // ALT-0176
-		// Last Updated Timestamp
-		struct tm* 	tmStruct = localtime(&(wd->lastUpdated));
-		strftime(updatedText, 20, 	"UP-%-m/%-d-%-I:%M%p", tmStruct);
-
-		//====// Draw data
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2,  2, skyBlue, NULL,   humidityText);
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2,  8, orange	 , NULL,  visibilityText);
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2, 14, pureGreen	 , NULL,  windText);
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2, 20, brightRed , NULL,   directionText);
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2, 26, pureYellow , NULL,   updatedText);
-
-
-		
-	}
-	break;
-
-
-	case WEATHER4:
-	{
-		offscreen->Clear();
-
-		if (screenChange)
-		{
-			screenChange = 0;
-		}
-
-		//====// Format Data
-		char ozoneText		[20] = 	"";
-		char pressureText	[20] = 	"";
-		char dewPointText	[20] = 	"";
-		char cloudText		[20] = 	"";
-		sprintf(ozoneText, 		"OZN-%.1f DU", wd->ozone);
-		sprintf(pressureText, 	"PRS-%.2f mb", wd->pressure);
-		sprintf(dewPointText, 	"DWP-%.2fF", wd->dewPoint);
-		sprintf(cloudText,  	"CLD-%d%%", wd->cloudCover);
-
-
-		//====// Draw data
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2,  2, skyBlue , NULL,   cloudText);
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2,  8, pureGreen	 , NULL,  dewPointText);
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2, 14, orange	 , NULL,  pressureText);
-		DrawTextByCenter(offscreen, f_4x6, M_WIDTH/2, 20, purple, NULL,   ozoneText);
-		
-		
-		
-	}
-	break;
-
-	case A_CLOCK:
-	{
-		// Static vars
-		static struct timespec nextTime;
-		static struct tm* timeStruct;
-		static char dayText			[10];
-		static char dateText		[10];
-		static char yearText		[10];
-		static char timeTextLine1	[15];
-		static char timeTextLine2	 [5];
-
-		if (screenChange) // Initial events
-		{
-			screenChange = 0;
-			// Initialize time vars, set to current time
-			nextTime.tv_sec = time(NULL);
-			//nextTime.tv_sec = 1565001008; // Bogus morning Test Time
-			//nextTime.tv_sec = 1565047808; // evening
-			nextTime.tv_nsec = 0;
-		}
-
-		offscreen->Clear();
-
-		static int cX = M_WIDTH/2 - 16;
-		static int cY = M_HEIGHT/2 - 1;
-		static int r = M_HEIGHT/2 - 1;
-
-		Color cir = darkBlue;
-		Color hr = orange;
-		Color min = purple;
-		Color sec = darkBlue;
-
-		// Process Time
-		timeStruct = localtime(&nextTime.tv_sec);
-		strftime(dayText, 10, 		"%a",		 	timeStruct);
-		strftime(dateText, 10, 		"%b %-d",		timeStruct);
-		strftime(yearText, 10, 		"%Y", 		 	timeStruct);
-		if (currSett["24hrMode"])
-		{
-			strftime(timeTextLine1, 15, "%H:%M:%S", 	timeStruct);
-			strftime(timeTextLine2, 5, 	"", 			timeStruct);
-		}
-		else // 12hr Mode
-		{
-			strftime(timeTextLine1, 15, "%-I:%M:%S", 	timeStruct);
-			strftime(timeTextLine2, 5, 	"%p", 			timeStruct);
-		}
-
-		//=====// Drawing
-		DrawAnalogClock(offscreen,cX,cY,r,cir,hr,min,sec,timeStruct);
-		DrawTextByCenter(offscreen, f_4x6, 47,  3, purple, NULL, 	dayText);
-		DrawTextByCenter(offscreen, f_4x6, 47,  9, darkBlue, NULL,	dateText);
-		DrawTextByCenter(offscreen, f_4x6, 47, 15, orange, NULL, 	yearText);
-		DrawTextByCenter(offscreen, f_4x6, 47, 21, purple, NULL, 	timeTextLine1);
-		DrawTextByCenter(offscreen, f_4x6, 47, 27, purple, NULL, 	timeTextLine2);
-		
-		// Sleep until system clock matches the next second tick
-		if (clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &nextTime, NULL) == EINTR)
-		{
-			// Woken by py signal, don't care, so go back to sleep
-			if (readNewData != 0)
-				clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &nextTime, NULL);
-			// Reset Time
-			nextTime.tv_sec = time(NULL);
-			nextTime.tv_nsec = 0;
-		}
-		else // Not Interrupted
-		{
-			offscreen = matrix->SwapOnVSync(offscreen, 1);
-			nextTime.tv_sec += 1;
-		}
-
-
-		flushBuffAtEnd = false;
-		refreshScreen = true; // Loop Continuously
-		
-	}
-		break;
-
-
-	case VOTD:
-	{
-		// Var declaration
-		static int x1;
-		if (screenChange) // Flag indicates first loop upon transition to this screen
-		{
-			// Init positions for scrolling texts
-			x1 = M_WIDTH;
-			screenChange = 0;
-		}
-
-		offscreen->Clear();
-		// Write forecast data
-		DrawTextCentered(offscreen,f_4x6, 5,orange,NULL,"Verse-Of-The-Day");
-		scrollText(x1,offscreen,f_4x6,	 11,pureGreen,NULL,verse.c_str());
-
-		/* Handle swapping here inside this loop, for this particular state 
-		   (To give instant response for state switching) */
-		offscreen = matrix->SwapOnVSync(offscreen, 1);
-		flushBuffAtEnd = false;
-		usleep(SCROLL_DELAY_USEC);
-
-	}
-		break;
-
-
-	case SETTINGS_ENTER:
-		offscreen->Clear();
-
-		if (screenChange)
-		{
-			screenChange = 0;
-		}
-
-		DrawTextByCenter(offscreen, f_5x7, 41, f_5x7.baseline()-2, brightRed, NULL, "Enter",0);
-		DrawTextByCenter(offscreen, f_5x7, 41, 2*f_5x7.baseline()-1, brightRed, NULL, "Settings",0);
-		ifaceIcons->drawCenter(0, offscreen, 11, 8);
-
-		break;
-
-	case BLANK:
-		offscreen->Clear();
-
-		if (screenChange)
-		{
-			screenChange = 0;
-		}
-		break;
-
-	case SETTINGS:
-	{
-		offscreen->Clear();
-
-		if (screenChange)
-		{
-			screenChange = 0;
-		}
-
-		vector<string> options(settingSelections);
-		
-		const Color ARROW_COLOR = orange;
-		const Color TEXT_COLOR = darkBlue;
-		
-		// Dynamic Brightness Text
-		if (currSett["autoBrightness"])
-			options[0].append("ON");
-		else
-			options[0].append("OFF");
-
-		const int vertSpacing = 1;
-		const int fromTop = 5;
-
-		int y;
-		uint8_t numOptions = options.size();
-		for (size_t i = 0; i < numOptions; i++) // Draw each option and selection arrow
-		{
-			int* xBound;
-
-			y = fromTop + i*(f_4x6.baseline() + vertSpacing);
-			xBound = DrawTextCentered(offscreen,f_4x6,y,TEXT_COLOR,NULL, options[i],0);
-
-			if (i == currSett["selection"]) // Draw Selection Arrows
-			{
-				int x1 = xBound[0] - f_4x6.CharacterWidth('>');
-				DrawText(offscreen,f_4x6,x1,y,ARROW_COLOR,NULL,">");
-				DrawText(offscreen,f_4x6,xBound[1]+1,y,ARROW_COLOR,NULL,"<");
-			}
-		}
-	}
-		break;
-
-
-	case BRIGHT_CHANGE:
-	{
-		offscreen->Clear();
-
-		if (screenChange)
-		{
-			screenChange = 0;
-		}
-
-		int b = currSett["brightness"];
-		string bText = "ManBrt=";
-		DrawTextCentered(offscreen,f_4x6,f_4x6.baseline(),darkBlue,NULL,bText);
-		DrawTextCentered(offscreen,f_4x6,2*f_4x6.baseline()+1,orange,NULL,to_string(b));
-		
-		
-	}
-		break;
-
-
-	case SHUTDOWN:
-		offscreen->Clear();
-
-		if (screenChange)
-		{
-			screenChange = 0;
-		}
-
-		weatherIcons->drawCenter(26, offscreen, 11, 8);
-		DrawTextCentJust(offscreen, f_5x7, 41, f_5x7.baseline()+1,   blue, NULL, "Powering");
-		DrawTextCentJust(offscreen, f_5x7, 42, 2*f_5x7.baseline()+1, blue, NULL, "down");
-		break;
-	}
-	
-
-	// Page flip - Tied to a fraction of the refresh rate
-	if (flushBuffAtEnd)
-		offscreen = matrix->SwapOnVSync(offscreen, 1);
-	
 }
 
 
@@ -686,13 +730,23 @@ void updateWeather()
 	if (readNewData == 2) // Signal from Python Script
 	{
 		readNewData = 0;
-		refreshScreen = true;
+		scheduler.dataChanged();
 		wd->readFromFile(WEATHER_FILE);
+		formatWeather();
+		prefetchIcons();
 		cerr << "Read weather data\n";
 		//wd->printDebugData();
 	}
 }
 
+void formatWeather()
+{
+	const WeatherText* old = wt;
+	wt = new WeatherText(*wd);
+	delete old;
+	summaryLayout.layout(wt->summaries);
+}
+
 
 void updateVerse()
 {
@@ -700,7 +754,7 @@ void updateVerse()
 	if (readNewData==1)
 	{
 		readNewData = 0;
-		refreshScreen = true;
+		scheduler.dataChanged();
 		readVerse();
 		cerr << "Read verse data\n";
 	}
@@ -717,31 +771,87 @@ void readVerse()
 
 		//cerr << verse << "\n";
 	}
+	verseLayout.layout(verse);
 }
 
 
-static void killHandler(int signo) 
+#ifndef SCREEN_BENCH
+// onFrame(): Frame or clock timer expired, draw the next frame
+static void onFrame(void* arg)
 {
-	fprintf(stderr,"Signal Received: %d\n",signo);
-	killSigReceived = true;
+	scheduler.tick();
 }
 
 
-static void InputWaker(int signo)
+// onInput(): The input thread logged an event
+static void onInput(void* arg)
 {
-	fprintf(stderr,"Input Event Logged\n");
 	inputReceived = true;
 }
 
 
-static void PyHandler(int signo)
+// onBrightness(): Time for another auto brightness sample
+static void onBrightness(void* arg)
+{
+	runAutoBright = true;
+}
+
+
+// onConfigFlush(): Writes the settings changed since the flush timer was armed
+static void onConfigFlush(void* arg)
 {
+	writeConfig();
+}
+
+
+// onSignal(): Kill signals stop the program, python signals set readNewData
+static void onSignal(int signo, void* arg)
+{
+	if (signo == SIGTERM || signo == SIGINT)
+	{
+		fprintf(stderr,"Signal Received: %d\n",signo);
+		killSigReceived = true;
+		return;
+	}
 	cerr << signo << " receieved\n";
 	if (signo == SIGRTMIN) // Verse Data
 		readNewData = 1;
 	if (signo == SIGRTMIN + 1) // Weather Data
 		readNewData = 2;
 }
+#endif // SCREEN_BENCH
+
+
+void scheduleFrames()
+{
+	// armed: Cadence the timers are running for, re-armed only when the showing screen needs another
+	static Screen::Cadence armed = Screen::STATIC;
+	const Screen::Cadence CADENCE = scheduler.cadence();
+	// A clock timer cancelled by a change to the system time re-aligns on the new time
+	if (CADENCE == armed && (CADENCE != Screen::PER_SECOND || reactor->armed(clockTimer)))
+		return;
+
+	reactor->disarmTimer(frameTimer);
+	reactor->disarmTimer(clockTimer);
+	if (CADENCE == Screen::PER_FRAME)
+		reactor->armTimer(frameTimer, 1e6/SCROLL_FPS, 1e6/SCROLL_FPS);
+	if (CADENCE == Screen::PER_SECOND)
+		reactor->armTimerAt(clockTimer, (time(NULL) + 1)*1e6, 1e6);
+	armed = CADENCE;
+}
+
+
+void scheduleTimers()
+{
+	const bool AUTO_BRIGHT_ON = currSett["autoBrightness"];
+	if (AUTO_BRIGHT_ON && !reactor->armed(brightTimer))
+		reactor->armTimer(brightTimer, BRIGHT_SAMPLE_SEC*1e6, BRIGHT_SAMPLE_SEC*1e6);
+	else if (!AUTO_BRIGHT_ON && reactor->armed(brightTimer))
+		reactor->disarmTimer(brightTimer);
+
+	if (runWriteConfig && !reactor->armed(configTimer))
+		reactor->armTimer(configTimer, CONFIG_FLUSH_SEC*1e6);
+}
 
 
 void loadFonts()
@@ -756,6 +866,35 @@ void loadFonts()
 	f_5x7.LoadFont(completePaths[2].c_str());
 	f_6x9.LoadFont(completePaths[3].c_str());
 	f_6x12.LoadFont(completePaths[4].c_str());
+
+	// Advance tables for getTotalWidth()
+	const BinFont* FONTS[] = {&atari, &f_4x6, &f_5x7, &f_6x9, &f_6x12};
+	int mapped = 0;
+	for (int i = 0; i < NUM_FONTS; i++)
+	{
+		FontMetrics::build(*FONTS[i]);
+		if (FONTS[i]->isMapped())
+			mapped++;
+	}
+	fprintf(stderr, "Fonts: %d of %d mapped precompiled, the rest parsed from BDF\n", mapped, NUM_FONTS);
+}
+
+
+void loadAssets()
+{
+	AssetLoader loader;
+	loader.add("weather", weatherIcons);
+	loader.add("interface", ifaceIcons);
+	if (!loader.run())
+		cerr << "Some icons failed to load\n";
+}
+
+
+void prefetchIcons()
+{
+	weatherIcons->prefetch(wd->iconMap);		// WEATHER1
+	weatherIcons->prefetch(wd->moonPhaseIcon);	// WEATHER2
+	ifaceIcons->prefetch(0);					// SETTINGS_ENTER
 }
 
 
@@ -766,32 +905,32 @@ inline bool fileExists (const string& name)
 }
 
 
-void DrawTextCentJust(FrameCanvas* c, const Font &font, int x, int y, const Color &color, const Color* backColor,
-					  const string text, int kOff)
+void DrawTextCentJust(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+					  const string &text, int kOff)
 {
 	int width = getTotalWidth(font, text, kOff);
 	
 	// Calculate left x coord from center x pos
 	int xBL = x - round(width/2.0);
 
-	DrawText(c, font, xBL, y, color, backColor, text.c_str(), kOff);
+	TextCache::shared().draw(c, font, xBL, y, color, backColor, text.c_str(), kOff);
 }
 
 
-void DrawTextRightJust(FrameCanvas* c, const Font &font, int x, int y, const Color &color, const Color* backColor,
-					  const string text, int kOff)
+void DrawTextRightJust(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+					  const string &text, int kOff)
 {
 	int width = getTotalWidth(font, text, kOff);
 	
 	// Calculate left x coord from far right x pos
 	int xBL = x - width + 1; // +1 is a correction
 
-	DrawText(c, font, xBL, y, color, backColor, text.c_str(), kOff);
+	TextCache::shared().draw(c, font, xBL, y, color, backColor, text.c_str(), kOff);
 }
 
 
-int* DrawTextCentered(FrameCanvas *c, const Font &font, int y, const Color &color, const Color *backColor,
-                      const string text, int kOff)
+int* DrawTextCentered(Canvas *c, const BinFont &font, int y, const Color &color, const Color *backColor,
+                      const string &text, int kOff)
 {
 	static int xBoundaries[2];
 
@@ -805,14 +944,14 @@ int* DrawTextCentered(FrameCanvas *c, const Font &font, int y, const Color &colo
 
 	//cerr << cWidth << " " << numChars << " " << totalWidth << " " << xDouble << " " << xInt << endl;
 	
-	DrawText(c, font, xInt, y, color, backColor, text.c_str(), kOff);
+	TextCache::shared().draw(c, font, xInt, y, color, backColor, text.c_str(), kOff);
 
 	return xBoundaries;
 }
 
 
-void DrawTextByCenter(FrameCanvas* c, const Font &font, int x, int y, const Color &color, const Color* backColor,
-					  const string text, int kOff)
+void DrawTextByCenter(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+					  const string &text, int kOff)
 {
 	int width = getTotalWidth(font, text, kOff);
 	int height = font.height();
@@ -821,61 +960,23 @@ void DrawTextByCenter(FrameCanvas* c, const Font &font, int x, int y, const Colo
 	int xBL = x - round(width/2.0) + 1; // +1 is a correction
 	int yBL = y + round(height/2.0);
 
-	DrawText(c, font, xBL, yBL, color, backColor, text.c_str(), kOff);
+	TextCache::shared().draw(c, font, xBL, yBL, color, backColor, text.c_str(), kOff);
 }
 
-int* DrawTextMultiColorCentered(FrameCanvas* c, const Font &font, int y, const vector<Color>, const Color* backColor,
+int* DrawTextMultiColorCentered(Canvas* c, const BinFont &font, int y, const vector<Color>, const Color* backColor,
 								const vector<string> strings)
 {
 	return NULL;
 }
 
-int getTotalWidth(const Font &font, const string text, int kOff)
-{
-	int cWidth = font.CharacterWidth('A'); // Includes 1 pixel offset at right for each char (in most fonts)
-	int numChars = text.length();
-	// Don't include offset for last char
-	int totalWidth = cWidth*numChars + (kOff)*(numChars - 1) - 1; // -1 is a correction
-	return totalWidth;
-}
-
-
-void scrollText(int &x, FrameCanvas* c, const Font &font, int y, const Color &color, const Color* backColor,
-				const string text, int kOff)
-{
-	// Total number of pixels horizontally
-	int totalWidth = getTotalWidth(font,text,kOff);
-
-	DrawText(c,font,x,y,color,backColor,text.c_str(),kOff);
-
-	if (x < -totalWidth) // When text is off screen
-		x = M_WIDTH; // Reset to far right
-	else
-		x--;
-
-	refreshScreen = true; // run drawLoop() continuously
-}
-
-
-void scrollTextAtCenter(int &x, FrameCanvas* c, const Font &font, int y, const Color &color, const Color* backColor,
-						const string text, int kOff)
+int getTotalWidth(const BinFont &font, const string &text, int kOff)
 {
-	// Total number of pixels horizontally
-	int totalWidth = getTotalWidth(font,text,kOff);
-	int yBL = y + round(font.height()/2.0);
-
-	DrawText(c,font,x,yBL,color,backColor,text.c_str(),kOff);
-
-	if (x < -totalWidth) // When text is off screen
-		x = M_WIDTH; // Reset to far right
-	else
-		x--;
-
-	refreshScreen = true; // run drawLoop() continuously
+	// Advance table built by loadFonts(), widths are memoized per string
+	return FontMetrics::of(font).width(text, kOff);
 }
 
 
-void DrawAnalogClock(FrameCanvas* c, int centerX, int centerY, int radius, Color &cir, Color &hr, Color &min,
+void DrawAnalogClock(Canvas* c, int centerX, int centerY, int radius, Color &cir, Color &hr, Color &min,
 					 Color &sec, struct tm* timeStruct, bool smallClock)
 {
 	int hrInt = timeStruct->tm_hour;
@@ -1090,7 +1191,7 @@ void autoBrightness()
 	ssLim[0] = sunsetSec - currSett["rampTime"]*30;
 	ssLim[1] = sunsetSec + currSett["rampTime"]*30;
 
-	uint8_t currB = matrix->brightness();
+	uint8_t currB = display->brightness();
 	uint8_t b = currB;
 	// Early Morning
 	if (currSec < srLim[0])
@@ -1110,7 +1211,7 @@ void autoBrightness()
 
 	if (currB != b)
 	{
-		matrix->SetBrightness(b);
+		display->setBrightness(b);
 		refreshScreen = true;
 	}
 
@@ -14,6 +14,15 @@
 #include "Weather.h"
 #include "RotInput.h"
 #include "ppm.h"
+#include "AssetLoader.h"
+#include "Animation.h"
+#include "TextCache.h"
+#include "FontMetrics.h"
+#include "Scroller.h"
+#include "TextLayout.h"
+#include "Reactor.h"
+#include "Screen.h"
+#include "Display.h"
 #include <unistd.h>
 #include <stdio.h>
 #include <signal.h>
@@ -39,7 +48,13 @@ const string WEATHER_FILE = SHARE_DIR + "weather_data.txt";
 const string PID_FILE = SHARE_DIR + "weather_pid.txt";
 const string CONFIG_FILE = SHARE_DIR + "weather-disp.cfg";
 const string VERSE_FILE = SHARE_DIR + "verse.txt";
-const int SCROLL_DELAY_USEC = 25000;
+// Scrolling text moves SCROLL_PX_PER_SEC by the clock, in frames paced at SCROLL_FPS (1 pixel a frame by default)
+const double SCROLL_PX_PER_SEC = 40;
+const int SCROLL_FPS = 40;
+// Settings changes are batched into one config write CONFIG_FLUSH_SEC after the first change
+const double CONFIG_FLUSH_SEC = 2;
+// Auto brightness samples every BRIGHT_SAMPLE_SEC while it's on
+const double BRIGHT_SAMPLE_SEC = 1;
 const double PI = 3.14159265358979323846;
 // Matrix Dimensions
 const int M_WIDTH = 64;
@@ -57,7 +72,7 @@ const int PWR_SW_PIN = 3; // SCL pin (also wakeup)
 /* 
  * //====// SCREEN STATE CONSTANTS
  * Functionally, this program loops from FIRST_SCREEN to LAST_SCREEN
- * To add a new screen, make a const for it, increment LAST_SCREEN, then add a draw loop for it.
+ * To add a new screen, make a const for it, increment LAST_SCREEN, then add a Screen class for it to registerScreens().
  */
 const uint8_t FIRST_SCREEN = 0; const uint8_t LAST_SCREEN = 7;
 const uint8_t WEATHER1 = 0; const uint8_t WEATHER2 = 1; const uint8_t WEATHER3 = 2;
@@ -85,32 +100,38 @@ unordered_map<string, unsigned char> defSett;
 // configFile: vector used for storing lines to be rewritten upon save
 vector<string> configFile;
 
-//===// ISR Flags (Interrupt Service Routines)
+//===// Event Flags (set by the reactor callbacks)
 
-// killSigReceived: ISR flag used to indicate that the program should be killed
+// killSigReceived: flag used to indicate that the program should be killed
 volatile bool killSigReceived = false;
-/*	readNewData: ISR flag to indicate which new data to read
+/*	readNewData: flag to indicate which new data to read
 	0 = None
 	1 = Verse Data
 	2 = Weather Data
  */
 volatile int readNewData = 0; 
-// inputReceived: ISR flag to indicate an input event was just received
+// inputReceived: flag to indicate an input event was just received
 volatile bool inputReceived = false;
 
 // These flags should not be reset until action is taken on them
 
-// refreshScreen:	flag used to indicate that drawLoop() should be executed in the next program loop
+// refreshScreen:	flag used to indicate that drawLoop() should draw the screen regardless of its cadence
 bool refreshScreen = true;
 // screenChange:	flag to indicate from inputLoop to drawLoop that a screen transition has occurred (execute prelim events for the screen)
 bool screenChange = true;
-// runWriteConfig:	flag to indicate that writeConfig() should be executed in next loop
+// runWriteConfig:	flag to indicate that writeConfig() should be executed on the next config flush
 bool runWriteConfig = false;
 // runAutoBright:	flag to indicate that autoBrightness() routine should be executed immediately in next loop
 bool runAutoBright = true;
+// startUsec:		monotonic time main() started, for reporting time-to-first-frame
+double startUsec = 0;
+// firstFrameShown:	flag set once the first frame has been drawn and the startup time reported
+bool firstFrameShown = false;
+// framesDrawn:		frames drawLoop() has drawn, for per-frame stats at exit
+unsigned long framesDrawn = 0;
 
 
-// testTime:		Bogus time used for testing
+// testTime:		Bogus time used for testing, shown by the clock screen when set (screen-bench's time fixture)
 time_t testTime = 0;
 
 
@@ -118,15 +139,28 @@ time_t testTime = 0;
 string verse = "No Verse Loaded";
 // wd: WeatherData object to hold data read in from weather file
 WeatherData* wd = new WeatherData;
+// wt: The strings the weather screens draw, rebuilt from wd by formatWeather() after every read
+const WeatherText* wt = new WeatherText(*wd);
 
 
 
-// matrix: Main matrix obj from library
-RGBMatrix* matrix;
+// display: The panel (a MatrixDisplay around the library's matrix obj), or a SoftDisplay with -s
+Display* display;
 // offscreen: Secondary canvas used for double buffering
-FrameCanvas* offscreen;
-// Input: RotInput obj used to run input thread for Rotary Encoder
-RotInput* Input;
+Canvas* offscreen;
+// Input: RotInput obj used to run input thread for Rotary Encoder, NULL when headless
+RotInput* Input = NULL;
+// scroller: Scrolling text lanes of the current screen
+Scroller scroller;
+// reactor: Event loop of main(), created after the matrix daemonizes
+Reactor* reactor;
+// scheduler: The screens by number, drawn when their cadence calls for it
+Scheduler scheduler;
+// damage: What the last render() repainted on offscreen, only that is sent to the display
+Damage damage(M_WIDTH, M_HEIGHT);
+// Reactor sources: the frame timer (PER_FRAME), second tick timer on the system clock (PER_SECOND), auto
+// brightness sampler, config flush, and the input thread's wakeup
+int frameTimer, clockTimer, brightTimer, configTimer, inputEvent;
 
 
 //=====// GLOBAL COLORS (32 color palette)
@@ -167,6 +201,8 @@ Color brightRed(0xff,0x06,0x00);
 Color pureRed(0xff,0x00,0x00);
 Color pureYellow(0xff,0xff,0x00);
 Color pureGreen(0x00,0xff,0x00);
+// Drop shadow of the scrolling text (TextCache renders it with each run)
+const TextEffect TEXT_SHADOW(TextEffect::SHADOW, shadow);
 
 
 //=====// GLOBAL FONTS
@@ -174,12 +210,28 @@ Color pureGreen(0x00,0xff,0x00);
 const string FONT_FP = "../rpi-rgb-led-matrix/fonts/";
 const vector<string> FONT_FILES = {"atari-small.bdf", "4x6.bdf", "5x7.bdf", "6x9.bdf", "clR6x12.bdf"};
 const int NUM_FONTS = FONT_FILES.size();
-Font atari, f_4x6, f_5x7, f_6x9, f_6x12;
+BinFont atari, f_4x6, f_5x7, f_6x9, f_6x12; // Mapped from the .bfnt files next to the BDFs (make fonts)
+// The draw helpers render each string once and blit it from TextCache::shared() afterwards, up to this many bytes
+const size_t TEXT_CACHE_BYTES = 64*1024;
+
+
+//=====// TEXT LAYOUTS
+// Wrapped text holds each line at the top of its window for LAYOUT_HOLD_SEC, then moves up at LAYOUT_PX_PER_SEC
+const double LAYOUT_HOLD_SEC = 2.5;
+const double LAYOUT_PX_PER_SEC = 12;
+// verseLayout: VOTD verse, wrapped by readVerse() into the 4 lines under the title
+TextLayout verseLayout(f_4x6, 0, 7, M_WIDTH, 4);
+// summaryLayout: WEATHER2 today and week summaries, wrapped by formatWeather() into the top line
+TextLayout summaryLayout(f_4x6, 0, 0, M_WIDTH, 1);
+const string VOTD_TITLE = "Verse-Of-The-Day";
 
 
 //=====// ANIMATIONS & ICONS
 // To add set of icons, follow the pattern set below. Don't forget to delete the Frames object at end of main()
+// Frames are decoded by loadAssets() at startup and kept in FrameCache::shared(), least recently drawn frames are
+// evicted past the budget and read back on their next draw
 const string IMAGES_DIR = "../img/";
+const size_t FRAME_CACHE_BYTES = 128*1024;
 
 // Weather Icons
 const string WEATHER_ICN_FP = IMAGES_DIR + "weather/";
@@ -195,32 +247,49 @@ Frames* ifaceIcons = new Frames(IFACE_ICN_FP, IFACE_ICN_CNT);
 
 //=====// FUNCTION PROTOTYPES
 
-//===// Interrupt (Signal) Handlers
+//===// Reactor Callbacks (run from reactor->runOnce() in the main loop, not built into screen-bench)
+#ifndef SCREEN_BENCH
 
-// killHandler(): Sets the flag that kills the program
-static void killHandler(int signo);
-/* 	InputWaker():	Just a basic handler to wake any currently sleeping functions, called by a signal
-					coming from RotInput thread to ensure quick response to input events  
-*/
-static void InputWaker(int signo);
-// PyHandler(): Handles signals from python scripts by setting appropriate flags.
-static void PyHandler(int signo);
+// onFrame(): Frame or clock timer expired, ticks the scheduler
+static void onFrame(void* arg);
+// onInput(): Wakeup from the RotInput thread, so input is handled as soon as it's dispatched
+static void onInput(void* arg);
+// onBrightness(): Brightness sample timer, sets runAutoBright
+static void onBrightness(void* arg);
+// onConfigFlush(): Config flush timer, calls writeConfig()
+static void onConfigFlush(void* arg);
+// onSignal(): Handles kill signals, and signals from python scripts by setting appropriate flags.
+static void onSignal(int signo, void* arg);
+#endif // SCREEN_BENCH
+
+// scheduleFrames(): Arms the frame or clock timer for the showing screen's cadence, only when it changes
+void scheduleFrames();
+// scheduleTimers(): Runs the brightness sampler while auto brightness is on, arms the config flush after a change
+void scheduleTimers();
 
 
-// drawLoop(): Main draw loop, handles drawing each screen
+// drawLoop(): Switches the scheduler to a new screen, and draws and swaps when the scheduler says it's due
 void drawLoop();
+// registerScreens(): Adds a Screen for each screen number to the scheduler
+void registerScreens();
 // inputLoop(): Main input loop, handles screen switching based on input from RotInput thread
 void inputLoop();
 
 
 // updateWeather(): Call readFile on WeatherData object when signal receieved
 void updateWeather();
+// formatWeather(): Replace wt with the strings formatted from the current wd
+void formatWeather();
 // updateVerse(): Call readVerse() when signal receieved
 void updateVerse();
 // readVerse(): Store the data from VERSE_FILE into the global verse string
 void readVerse();
-// loadFonts(): Load Font objects
+// loadFonts(): Load BinFont objects (precompiled .bfnt when available) and build their metrics
 void loadFonts();
+// loadAssets(): Startup phase, decodes every icon set across the cores (AssetLoader) before the first frame
+void loadAssets();
+// prefetchIcons(): Loads the icons the current weather data will draw, so screen changes don't wait on the SD card
+void prefetchIcons();
 
 
 // fileExists(): Checks if the file exists on the disk
@@ -228,12 +297,12 @@ bool fileExists (const string& name);
 
 // Function: DrawTextCentJust()
 // Purpose:  Draws text justified at center. Coords will be at the baseline, horiz center of text.
-void DrawTextCentJust(FrameCanvas* c, const Font &font, int x, int y, const Color &color, const Color* backColor,
-					  const string text, int kOff = 0);
+void DrawTextCentJust(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+					  const string &text, int kOff = 0);
 // Function: DrawTextRightJust()
 // Purpose:  Draws text justified at right. Coords will be at the baseline, far right of text.
-void DrawTextRightJust(FrameCanvas* c, const Font &font, int x, int y, const Color &color, const Color* backColor,
-					  const string text, int kOff = 0);
+void DrawTextRightJust(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+					  const string &text, int kOff = 0);
 /*
 	Function: DrawTextCentered()
 	Purpose:  Draws text centered horizontally on the screen using the parameters, no x coord necessary
@@ -243,35 +312,24 @@ void DrawTextRightJust(FrameCanvas* c, const Font &font, int x, int y, const Col
 		on either side, like selection arrows in a different color
 		**This array is static and overwritten with each call to this function**
  */
-int* DrawTextCentered(FrameCanvas *c, const Font &font, int y, const Color &color, const Color *backColor,
-                      const string text, int kOff = 0);
+int* DrawTextCentered(Canvas *c, const BinFont &font, int y, const Color &color, const Color *backColor,
+                      const string &text, int kOff = 0);
 // DrawTextByCenter(): Draws text with the given parameters. X and Y positions will be the approximate CENTER of the text.
 //					   This center is horiz and vert
-void DrawTextByCenter(FrameCanvas* c, const Font &font, int x, int y, const Color &color, const Color* backColor,
-					  const string text, int kOff = 0);
+void DrawTextByCenter(Canvas* c, const BinFont &font, int x, int y, const Color &color, const Color* backColor,
+					  const string &text, int kOff = 0);
 // DrawTextMultiColorCentered(): TODO
-int* DrawTextMultiColorCentered(FrameCanvas* c, const Font &font, int y, const vector<Color>, const Color* backColor,
+int* DrawTextMultiColorCentered(Canvas* c, const BinFont &font, int y, const vector<Color>, const Color* backColor,
 								const vector<string> strings);
-// getTotalWidth(): Returns the total # of pixels the string will horizontally occupy, with the given kerning offset
-int getTotalWidth(const Font &font, const string text, int kOff=0);
-/*
-	scrollText(): Handles the x-pos for moving a text string from offscreen RHS to offscreen LHS. Advances one pixel per call. Handle a scroll delay externally.
-		Uses M_WIDTH constant to determine matrix width. y parameter is the baseline level (approx. bottom). Start x at M_WIDTH to be offscreen.
-*/
-void scrollText(int &x, FrameCanvas* c, const Font &font, int y, const Color &color, const Color* backColor,
-				const string text, int kOff=0);
-/*
-	scrollTextAtCenter(): Handles the x-pos for moving a text string from offscreen RHS to offscreen LHS. Advances one pixel per call. Handle a scroll delay externally.
-		Uses M_WIDTH constant to determine matrix width. y parameter is at the approximate CENTER of the text, like DrawTextByCenter(). Start x at M_WIDTH to be offscreen.
-*/
-void scrollTextAtCenter(int &x, FrameCanvas* c, const Font &font, int y, const Color &color, const Color* backColor,
-						const string text, int kOff=0);
+// getTotalWidth(): Returns the total # of pixels the string will horizontally occupy, with the given kerning offset.
+//					Decoded to glyphs (UTF-8 aware, with substitutions) once through FontMetrics, memoized per string.
+int getTotalWidth(const BinFont &font, const string &text, int kOff=0);
 /*
 	Function: DrawAnalogClock()
 	Params: Colors are for main circle, hour, minute, and second hands
 			Set smallClock = true to make a small clock less cluttered
  */
-void DrawAnalogClock(FrameCanvas* c, int centerX, int centerY, int radius, Color &cir, Color &hr, Color &min,
+void DrawAnalogClock(Canvas* c, int centerX, int centerY, int radius, Color &cir, Color &hr, Color &min,
 					 Color &sec, struct tm* timeStruct, bool smallClock = false);
 
 
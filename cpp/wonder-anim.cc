@@ -3,39 +3,49 @@
 // Wonder Animation
 const string WONDER_FP = IMAGES_DIR + "wonder/"; // Just append frame numbers, starting with 0
 const int WONDER_FRM_CNT=24;
-Frames* wonderFrames = new Frames(WONDER_FP, WONDER_FRM_CNT);
+const double WONDER_FRAME_USEC = 0.25e6;
+Animation* wonderAnim = NULL; // Keyframe + deltas, built on first use
 
 
-case ANIM_1:
-	{
-		static int frameNum = 0;
-		static int DELAY_USEC = 0.25e6;
-		if (screenChange) // Initial events
-		{
-			screenChange = false;
-			frameNum = 0;
-		}
-
-		offscreen->Clear();
-		int imgWidth = wonderFrames->getImgWidth(frameNum);
-
-		wonderFrames->draw(frameNum, offscreen, M_WIDTH/2 - imgWidth/2, 0);
+// Registered in registerScreens() as scheduler.add(ANIM_1, new WonderScreen);
+class WonderScreen : public Screen
+{
+	double startUsec;	// When the screen came up, the frames are paced from it
+	int shownFrame;		// Frame on the canvas
 
-		offscreen = matrix->SwapOnVSync(offscreen, 1);
-		flushBuffAtEnd = false;
-		refreshScreen = true;
-
-		usleep(DELAY_USEC);
-		if (frameNum > 0) // Cycle through frames backwards (CW spin)
-		{
-			frameNum--;
-		}
-		else
-		{
-			frameNum = WONDER_FRM_CNT-1;
-		}
-		
+	// frameNow(): Frame for the current time, cycling through the frames backwards (CW spin)
+	int frameNow() const
+	{
+		const long STEPS = (AssetLoader::nowUsec() - startUsec)/WONDER_FRAME_USEC;
+		return (WONDER_FRM_CNT - 1) - STEPS % WONDER_FRM_CNT;
 	}
-		break;
+	int xPos() const { return M_WIDTH/2 - wonderAnim->getWidth()/2; }
 
-        
\ No newline at end of file
+public:
+	WonderScreen() : Screen("ANIM_1"), startUsec(0), shownFrame(0) {}
+	void enter()
+	{
+		if (wonderAnim == NULL)
+			wonderAnim = new Animation(WONDER_FP, WONDER_FRM_CNT);
+		startUsec = AssetLoader::nowUsec();
+	}
+	// The Scheduler cleared the canvas, so the animation no longer shows on it: draw the whole frame
+	void draw(Canvas* c)
+	{
+		wonderAnim->invalidate(c);
+		shownFrame = frameNow();
+		wonderAnim->draw(shownFrame, c, xPos(), 0);
+	}
+	// The canvas still holds the last frame, only the pixels that differ from the next one are written
+	bool update(Canvas* c, Damage &damage)
+	{
+		const int FRAME = frameNow();
+		if (FRAME == shownFrame)
+			return true; // Nothing changed, nothing damaged
+		wonderAnim->draw(FRAME, c, xPos(), 0);
+		damage.add(Rect(xPos(), 0, wonderAnim->getWidth(), wonderAnim->getHeight()));
+		shownFrame = FRAME;
+		return true;
+	}
+	Cadence cadence() const { return PER_FRAME; }
+};